@@ -14,14 +14,20 @@ public class ModularGameplayAbilities : ModuleRules
 			"GameplayTasks",
 			"GameplayTags",
 			"EnhancedInput",
+			"NetCore",
 		});
 
 		PrivateDependencyModuleNames.AddRange(new[]
 		{
 			"CoreUObject",
 			"Engine",
-			"NetCore",
 			"AIModule",
 		});
+
+		// The plugin settings are registered with the settings module in editor builds
+		if (Target.bBuildEditor)
+		{
+			PrivateIncludePathModuleNames.Add("Settings");
+		}
 	}
 }
@@ -79,3 +79,19 @@ void FModularAbilityCost_AdditionalGameplayEffect::ApplyCost(
 		}
 	}
 }
+
+void FModularAbilityCost_AdditionalGameplayEffect::GetCostAttributes(TArray<FGameplayAttribute>& OutAttributes) const
+{
+	if (AdditionalCostEffect == nullptr)
+	{
+		return;
+	}
+
+	if (const UGameplayEffect* CostEffect = AdditionalCostEffect->GetDefaultObject<UGameplayEffect>())
+	{
+		for (const FGameplayModifierInfo& Modifier : CostEffect->Modifiers)
+		{
+			OutAttributes.AddUnique(Modifier.Attribute);
+		}
+	}
+}
@@ -40,6 +40,7 @@ UModularGameplayAbility::UModularGameplayAbility(const FObjectInitializer& Objec
 	ActivationPolicy = EGameplayAbilityActivationPolicy::Active;
 	ActivationGroup = EGameplayAbilityActivationGroup::Independent;
 	bActivateIfTagsAlreadyPresent =  false;
+	bActivateWhenRequiredTagsAdded = false;
 	bForceReceiveInput = false;
 	bLogCancelation = false;
 	LastInputCallbackTime = 0.0f;
@@ -47,6 +48,8 @@ UModularGameplayAbility::UModularGameplayAbility(const FObjectInitializer& Objec
 	bStartWithCooldown = false;
 	bPersistCooldownOnDeath = true;
 	ExplicitCooldownDuration.Value = 0.f;
+	MaxCharges.Value = 0.f;
+	ChargeRechargeDuration.Value = 0.f;
 
 	bApplyingCostsEnabled = true;
 
@@ -374,12 +377,6 @@ void UModularGameplayAbility::ClearTrackedGroupedActors(FGameplayTag GroupTag, b
 
 void UModularGameplayAbility::TryActivateAbilityOnSpawn(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) const
 {
-#if ENGINE_VERSION_OLDER_5_4
-	const bool bIsPredicting = (GetCurrentActivationInfo().ActivationMode == EGameplayAbilityActivationMode::Predicting);
-#else
-	const bool bIsPredicting = (Spec.ActivationInfo.ActivationMode == EGameplayAbilityActivationMode::Predicting);
-#endif
-
 	UAbilitySystemComponent* ASC = ActorInfo->AbilitySystemComponent.Get();
 
 	const bool bIsPassiveAbility = (ActivationPolicy == EGameplayAbilityActivationPolicy::Passive);
@@ -397,8 +394,8 @@ void UModularGameplayAbility::TryActivateAbilityOnSpawn(const FGameplayAbilityAc
 			return true;
 		}
 
-		if (ASC->GetOwnedGameplayTags().HasAllExact(ActivationRequiredTags) &&
-			bActivateIfTagsAlreadyPresent)
+		if (bActivateIfTagsAlreadyPresent &&
+			HasPassiveActivationRequiredTags(*ASC))
 		{
 			return true;
 		}
@@ -406,11 +403,36 @@ void UModularGameplayAbility::TryActivateAbilityOnSpawn(const FGameplayAbilityAc
 		return false;
 	};
 
+	if (HasRequiredTags())
+	{
+		TryActivatePassiveAbility(ActorInfo, Spec);
+	}
+}
+
+bool UModularGameplayAbility::HasPassiveActivationRequiredTags(const UAbilitySystemComponent& AbilitySystem) const
+{
+	return AbilitySystem.GetOwnedGameplayTags().HasAllExact(ActivationRequiredTags);
+}
+
+const FGameplayTagContainer& UModularGameplayAbility::GetPassiveActivationWatchedTags() const
+{
+	const bool bWatchesTags = (ActivationPolicy == EGameplayAbilityActivationPolicy::Passive) && bActivateWhenRequiredTagsAdded;
+	return bWatchesTags ? ActivationRequiredTags : FGameplayTagContainer::EmptyContainer;
+}
+
+void UModularGameplayAbility::TryActivatePassiveAbility(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) const
+{
+#if ENGINE_VERSION_OLDER_5_4
+	const bool bIsPredicting = (GetCurrentActivationInfo().ActivationMode == EGameplayAbilityActivationMode::Predicting);
+#else
+	const bool bIsPredicting = (Spec.ActivationInfo.ActivationMode == EGameplayAbilityActivationMode::Predicting);
+#endif
+
 	if (ActorInfo &&
 		!Spec.IsActive() &&
-		!bIsPredicting &&
-		HasRequiredTags())
+		!bIsPredicting)
 	{
+		UAbilitySystemComponent* ASC = ActorInfo->AbilitySystemComponent.Get();
 		const AActor* AvatarActor = ActorInfo->AvatarActor.Get();
 
 		if (ASC &&
@@ -725,12 +747,24 @@ void UModularGameplayAbility::OnInputChangedCallback(bool bIsPressed)
 	FScopedPredictionWindow PredictionWindow(AbilitySystem, IsPredictingClient());
 	if (IsPredictingClient())
 	{
-		// Notify the server about this callback
-		AbilitySystem->ServerSetReplicatedEvent(
-			EventType,
-			GetCurrentAbilitySpecHandle(),
-			GetCurrentActivationInfo().GetActivationPredictionKey(),
-			AbilitySystem->ScopedPredictionKey);
+		// Notify the server about this callback, bundled with all other input events of this frame.
+		// RPCs the input handlers below may send (activation, end, target data, confirm, cancel) flush the queue first, so they can't overtake it.
+		if (UModularAbilitySystemComponent* ModularAbilitySystem = Cast<UModularAbilitySystemComponent>(AbilitySystem))
+		{
+			ModularAbilitySystem->QueueReplicatedInputEvent(
+				GetCurrentAbilitySpecHandle(),
+				GetCurrentActivationInfo().GetActivationPredictionKey(),
+				ModularAbilitySystem->ScopedPredictionKey,
+				bIsPressed);
+		}
+		else
+		{
+			AbilitySystem->ServerSetReplicatedEvent(
+				EventType,
+				GetCurrentAbilitySpecHandle(),
+				GetCurrentActivationInfo().GetActivationPredictionKey(),
+				AbilitySystem->ScopedPredictionKey);
+		}
 	}
 	else
 	{
@@ -776,6 +810,12 @@ void UModularGameplayAbility::EndAbility(
 	// When this ability was ended, make sure we have no pending delegates still assigned to the ASC
 	if (UAbilitySystemComponent* AbilitySystem = GetAbilitySystemComponentFromActorInfo())
 	{
+		// Send any queued input events before the server is told that we ended
+		if (UModularAbilitySystemComponent* ModularAbilitySystem = Cast<UModularAbilitySystemComponent>(AbilitySystem))
+		{
+			ModularAbilitySystem->FlushReplicatedInputEvents();
+		}
+
 		// Remove pressed delegate
 		AbilitySystem->AbilityReplicatedEventDelegate(
 			EAbilityGenericReplicatedEvent::InputPressed,
@@ -826,6 +866,12 @@ void UModularGameplayAbility::CancelAbility(
 	}
 #endif
 
+	// Send any queued input events before the server is told that we got canceled
+	if (UModularAbilitySystemComponent* ModularAbilitySystem = Cast<UModularAbilitySystemComponent>(GetAbilitySystemComponentFromActorInfo()))
+	{
+		ModularAbilitySystem->FlushReplicatedInputEvents();
+	}
+
 	Super::CancelAbility(Handle, ActorInfo, ActivationInfo, bReplicateCancelAbility);
 }
 
@@ -934,7 +980,118 @@ bool UModularGameplayAbility::CheckCooldown(
 	const FGameplayAbilityActorInfo* ActorInfo,
 	FGameplayTagContainer* OptionalRelevantTags) const
 {
-	return Super::CheckCooldown(Handle, ActorInfo, OptionalRelevantTags);
+	const int32 AbilityLevel = GetAbilityLevel(Handle, ActorInfo);
+	bool bOnCooldown = false;
+
+	if (const UModularAbilitySystemComponent* ChargeAbilitySystem = GetChargeAbilitySystem(ActorInfo, AbilityLevel))
+	{
+		// Abilities with charges are only on cooldown while they have no charge left
+		bOnCooldown = ChargeAbilitySystem->GetAbilityCharges(Handle, GetMaxCharges(AbilityLevel)) <= 0;
+	}
+	else if (const UModularAbilitySystemComponent* GroupAbilitySystem = GetCooldownGroupAbilitySystem(ActorInfo))
+	{
+		// Only the group's entry needs to be checked, rather than matching cooldown tags against the owned tags
+		bOnCooldown = GroupAbilitySystem->IsCooldownGroupActive(CooldownGroupTag);
+	}
+	else if (const UModularAbilitySystemComponent* LedgerAbilitySystem = GetCooldownLedgerAbilitySystem(ActorInfo))
+	{
+		const UModularGameplayAbility* AbilityCDO = GetClass()->GetDefaultObject<UModularGameplayAbility>();
+		const FGameplayTagContainer* CooldownTags = AbilityCDO->GetCooldownTagsForLevel(AbilityLevel);
+
+		bOnCooldown = CooldownTags && LedgerAbilitySystem->IsOnLedgerCooldown(*CooldownTags);
+	}
+	else
+	{
+		return Super::CheckCooldown(Handle, ActorInfo, OptionalRelevantTags);
+	}
+
+	if (bOnCooldown)
+	{
+		const FGameplayTag& FailCooldownTag = UAbilitySystemGlobals::Get().ActivateFailCooldownTag;
+		if (OptionalRelevantTags && FailCooldownTag.IsValid())
+		{
+			OptionalRelevantTags->AddTag(FailCooldownTag);
+		}
+	}
+
+	return !bOnCooldown;
+}
+
+int32 UModularGameplayAbility::GetCurrentCharges() const
+{
+	const FGameplayAbilityActorInfo* ActorInfo = GetCurrentActorInfo();
+	const int32 AbilityLevel = GetAbilityLevel();
+
+	if (const UModularAbilitySystemComponent* ChargeAbilitySystem = GetChargeAbilitySystem(ActorInfo, AbilityLevel))
+	{
+		return ChargeAbilitySystem->GetAbilityCharges(GetCurrentAbilitySpecHandle(), GetMaxCharges(AbilityLevel));
+	}
+
+	return 0;
+}
+
+float UModularGameplayAbility::GetCooldownTimeRemaining(const FGameplayAbilityActorInfo* ActorInfo) const
+{
+	if (GetCooldownLedgerAbilitySystem(ActorInfo) || GetCooldownGroupAbilitySystem(ActorInfo) || GetChargeAbilitySystem(ActorInfo, GetAbilityLevel()))
+	{
+		float TimeRemaining = 0.f;
+		float CooldownDuration = 0.f;
+		GetCooldownTimeRemainingAndDuration(GetCurrentAbilitySpecHandle(), ActorInfo, TimeRemaining, CooldownDuration);
+		return TimeRemaining;
+	}
+
+	return Super::GetCooldownTimeRemaining(ActorInfo);
+}
+
+void UModularGameplayAbility::GetCooldownTimeRemainingAndDuration(
+	FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo,
+	float& TimeRemaining,
+	float& CooldownDuration) const
+{
+	const int32 AbilityLevel = GetAbilityLevel(Handle, ActorInfo);
+
+	if (const UModularAbilitySystemComponent* ChargeAbilitySystem = GetChargeAbilitySystem(ActorInfo, AbilityLevel))
+	{
+		TimeRemaining = 0.f;
+		CooldownDuration = 0.f;
+
+		// Only report the recharge as a cooldown once the ability can't be activated anymore
+		const FModularAbilityChargeEntry* ChargeEntry = ChargeAbilitySystem->FindAbilityCharges(Handle);
+		const double Now = ChargeAbilitySystem->GetCooldownLedgerTime();
+
+		if (ChargeEntry && ChargeEntry->GetCharges(Now) <= 0)
+		{
+			TimeRemaining = ChargeEntry->GetTimeUntilNextCharge(Now);
+			CooldownDuration = ChargeEntry->RechargeDuration;
+		}
+
+		return;
+	}
+
+	if (const UModularAbilitySystemComponent* GroupAbilitySystem = GetCooldownGroupAbilitySystem(ActorInfo))
+	{
+		GroupAbilitySystem->GetCooldownGroupTimeRemaining(CooldownGroupTag, TimeRemaining, CooldownDuration);
+		return;
+	}
+
+	if (const UModularAbilitySystemComponent* LedgerAbilitySystem = GetCooldownLedgerAbilitySystem(ActorInfo))
+	{
+		const UModularGameplayAbility* AbilityCDO = GetClass()->GetDefaultObject<UModularGameplayAbility>();
+		const FGameplayTagContainer* CooldownTags = AbilityCDO->GetCooldownTagsForLevel(AbilityLevel);
+
+		TimeRemaining = 0.f;
+		CooldownDuration = 0.f;
+
+		if (CooldownTags)
+		{
+			LedgerAbilitySystem->GetLedgerCooldownTimeRemaining(*CooldownTags, TimeRemaining, CooldownDuration);
+		}
+
+		return;
+	}
+
+	Super::GetCooldownTimeRemainingAndDuration(Handle, ActorInfo, TimeRemaining, CooldownDuration);
 }
 
 void UModularGameplayAbility::ApplyCooldown(
@@ -944,10 +1101,48 @@ void UModularGameplayAbility::ApplyCooldown(
 {
 	const int32 AbilityLevel = GetAbilityLevel(Handle, ActorInfo);
 
-	if (HasExplicitCooldownDuration())
+	if (UModularAbilitySystemComponent* ChargeAbilitySystem = GetChargeAbilitySystem(ActorInfo, AbilityLevel))
+	{
+		// Consuming a charge replaces the cooldown, the ability only goes on cooldown once all charges are used up
+		if (HasAuthorityOrPredictionKey(ActorInfo, &ActivationInfo))
+		{
+			const float RechargeDuration = ChargeRechargeDuration.GetValueAtLevel(AbilityLevel);
+			ChargeAbilitySystem->ConsumeAbilityCharge(Handle, GetMaxCharges(AbilityLevel), RechargeDuration, ActivationInfo.GetActivationPredictionKey());
+
+			// Let others know we applied a cooldown. Charges don't grant any cooldown tags
+			OnApplyCooldownDelegate.Broadcast(this, RechargeDuration, FGameplayTagContainer());
+		}
+	}
+	else if (UModularAbilitySystemComponent* GroupAbilitySystem = GetCooldownGroupAbilitySystem(ActorInfo))
+	{
+		// The whole group goes on cooldown instead of the ability's own cooldown tags
+		if (HasAuthorityOrPredictionKey(ActorInfo, &ActivationInfo))
+		{
+			const float Duration = HasExplicitCooldownDuration()
+				? ExplicitCooldownDuration.GetValueAtLevel(AbilityLevel)
+				: GetCooldownEffectDuration(Handle, ActorInfo, ActivationInfo, AbilityLevel);
+
+			if (Duration > 0.f)
+			{
+				GroupAbilitySystem->ApplyCooldownGroup(CooldownGroupTag, Duration, ActivationInfo.GetActivationPredictionKey());
+
+				// Only build a tag container if anyone listens
+				NotifyCooldownApplied(Handle, ActorInfo, Duration, OnApplyCooldownDelegate.IsBound() ? FGameplayTagContainer(CooldownGroupTag) : FGameplayTagContainer());
+			}
+		}
+	}
+	else if (HasExplicitCooldownDuration())
 	{
 		ApplyCooldownWithDuration(Handle, ActorInfo, ActivationInfo, ExplicitCooldownDuration.GetValueAtLevel(AbilityLevel));
 	}
+	else if (UModularAbilitySystemComponent* LedgerAbilitySystem = GetCooldownLedgerAbilitySystem(ActorInfo))
+	{
+		UGameplayEffect* CooldownGE = GetCooldownGameplayEffect();
+		if (CooldownGE && HasAuthorityOrPredictionKey(ActorInfo, &ActivationInfo))
+		{
+			ApplyLedgerCooldown(LedgerAbilitySystem, Handle, ActorInfo, ActivationInfo, CooldownGE->GetGrantedTags(), GetCooldownEffectDuration(Handle, ActorInfo, ActivationInfo, AbilityLevel));
+		}
+	}
 	else
 	{
 		UGameplayEffect* CooldownGE = GetCooldownGameplayEffect();
@@ -961,8 +1156,7 @@ void UModularGameplayAbility::ApplyCooldown(
 					SpecHandle.Data->SetStackCount(1);
 					ApplyGameplayEffectSpecToOwner(Handle, ActorInfo, ActivationInfo, SpecHandle);
 
-					// Let others know we applied a cooldown
-					OnApplyCooldownDelegate.Broadcast(this, SpecHandle.Data->Duration, ExplicitCooldownTags);
+					NotifyCooldownApplied(Handle, ActorInfo, SpecHandle.Data->Duration, ExplicitCooldownTags);
 				}
 			}
 		}
@@ -983,33 +1177,48 @@ void UModularGameplayAbility::ApplyCooldownWithDuration(
 	{
 		return;
 	}
-	const FGameplayEffectSpecHandle CooldownSpecHandle = MakeOutgoingGameplayEffectSpec(CooldownEffectCDO->GetClass(), AbilityLevel);
 
-	// Check if we have valid cooldown tags
-	if (ExplicitCooldownTags.IsValid())
+	if (UModularAbilitySystemComponent* LedgerAbilitySystem = GetCooldownLedgerAbilitySystem(ActorInfo))
 	{
-		CooldownSpecHandle.Data->SetDuration(Duration, true);
+		if (!ExplicitCooldownTags.IsValid())
+		{
+			ABILITY_LOG(Error, TEXT("ExplicitCooldownTags are not valid for ability %s. Cooldown will not be applied."), *GetName());
+			return;
+		}
 
-		CooldownSpecHandle.Data->AppendDynamicAssetTags(ExplicitCooldownAssetTags);
-		CooldownSpecHandle.Data->DynamicGrantedTags.AppendTags(ExplicitCooldownTags);
+		// Same tags the cooldown effect would grant
+		FGameplayTagContainer CooldownTags = CooldownEffectCDO->GetGrantedTags();
+		CooldownTags.AppendTags(ExplicitCooldownTags);
 
-		if (bPersistCooldownOnDeath)
+		if (HasAuthorityOrPredictionKey(ActorInfo, &ActivationInfo))
 		{
-			//CooldownSpecHandle.Data->AppendDynamicAssetTags()
+			ApplyLedgerCooldown(LedgerAbilitySystem, Handle, ActorInfo, ActivationInfo, CooldownTags, Duration);
 		}
+
+		return;
 	}
-	else
+
+	// Check if we have valid cooldown tags
+	if (!ExplicitCooldownTags.IsValid())
 	{
 		ABILITY_LOG(Error, TEXT("ExplicitCooldownTags are not valid for ability %s. Cooldown will not be applied."), *GetName());
 		return;
 	}
 
+	// The tags are already applied to the template, only the activation state is refreshed
+	const FGameplayEffectSpecHandle CooldownSpecHandle = MakeCooldownSpecFromTemplate(Handle, ActorInfo, CooldownEffectCDO, AbilityLevel);
+	if (!CooldownSpecHandle.IsValid())
+	{
+		return;
+	}
+
+	CooldownSpecHandle.Data->SetDuration(Duration, true);
+
 	// Apply cooldown
 	FActiveGameplayEffectHandle CooldownHandle =
 		ApplyGameplayEffectSpecToOwner(Handle, ActorInfo, ActivationInfo, CooldownSpecHandle);
 
-	// Let others know we applied a cooldown
-	OnApplyCooldownDelegate.Broadcast(this, Duration, ExplicitCooldownTags);
+	NotifyCooldownApplied(Handle, ActorInfo, Duration, ExplicitCooldownTags);
 }
 
 bool UModularGameplayAbility::DoesAbilitySatisfyTagRequirements(
@@ -1035,41 +1244,22 @@ bool UModularGameplayAbility::DoesAbilitySatisfyTagRequirements(
 		bBlocked = true;
 	}
 
+	// Expand our ability tags by adding additional required/blocked tags, cached by the ASC
 	const UModularAbilitySystemComponent* ModularAbilitySystem = Cast<UModularAbilitySystemComponent>(&AbilitySystemComponent);
-	static FGameplayTagContainer AllRequiredTags;
-	static FGameplayTagContainer AllBlockedTags;
+	const FModularAbilityActivationTagRequirements* Requirements = ModularAbilitySystem ? &ModularAbilitySystem->GetActivationTagRequirements(this) : nullptr;
 
-	AllRequiredTags = ActivationRequiredTags;
-	AllBlockedTags = ActivationBlockedTags;
+	const FGameplayTagContainer& AllRequiredTags = Requirements ? Requirements->RequiredTags : ActivationRequiredTags;
+	const FGameplayTagContainer& AllBlockedTags = Requirements ? Requirements->BlockedTags : ActivationBlockedTags;
 
-	// Expand our ability tags by adding additional required/blocked tags
-	if (ModularAbilitySystem)
-	{
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 5
-		ModularAbilitySystem->GetAdditionalActivationTagRequirements(GetAssetTags(), AllRequiredTags, AllBlockedTags);
-#else
-		ModularAbilitySystem->GetAdditionalActivationTagRequirements(AbilityTags, AllRequiredTags, AllBlockedTags);
-#endif
-	}
-
-	// Check to see the required/blocked tags for this ability
+	// Check to see the required/blocked tags for this ability, directly against the owned tag counts
 	if (AllBlockedTags.Num() || AllRequiredTags.Num())
 	{
-		static FGameplayTagContainer AbilitySystemTags;
-		AbilitySystemTags.Reset();
-		AbilitySystemComponent.GetOwnedGameplayTags(AbilitySystemTags);
-
-		if (AbilitySystemTags.HasAny(AllBlockedTags))
+		if (AbilitySystemComponent.HasAnyMatchingGameplayTags(AllBlockedTags))
 		{
-			if (OptionalRelevantTags) // Add additional tag checks
-			{
-
-			}
-
 			bBlocked = true;
 		}
 
-		if (!AbilitySystemTags.HasAll(AllRequiredTags))
+		if (!AbilitySystemComponent.HasAllMatchingGameplayTags(AllRequiredTags))
 		{
 			bMissing = true;
 		}
@@ -1133,22 +1323,127 @@ bool UModularGameplayAbility::DoesAbilitySatisfyTagRequirements(
 	return true;
 }
 
+UModularAbilitySystemComponent* UModularGameplayAbility::GetChargeAbilitySystem(const FGameplayAbilityActorInfo* ActorInfo, int32 AbilityLevel) const
+{
+	if (!UsesCharges(AbilityLevel) || ActorInfo == nullptr)
+	{
+		return nullptr;
+	}
+
+	return Cast<UModularAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get());
+}
+
+UModularAbilitySystemComponent* UModularGameplayAbility::GetCooldownGroupAbilitySystem(const FGameplayAbilityActorInfo* ActorInfo) const
+{
+	if (!CooldownGroupTag.IsValid() || ActorInfo == nullptr)
+	{
+		return nullptr;
+	}
+
+	return Cast<UModularAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get());
+}
+
+float UModularGameplayAbility::GetCooldownEffectDuration(
+	const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo,
+	const FGameplayAbilityActivationInfo& ActivationInfo,
+	int32 AbilityLevel) const
+{
+	UGameplayEffect* CooldownGE = GetCooldownGameplayEffect();
+	if (CooldownGE == nullptr)
+	{
+		return 0.f;
+	}
+
+	// The spec is never applied, it is only built to evaluate the duration of the cooldown effect
+	const FGameplayEffectSpecHandle SpecHandle = MakeOutgoingGameplayEffectSpec(Handle, ActorInfo, ActivationInfo, CooldownGE->GetClass(), AbilityLevel);
+	return SpecHandle.IsValid() ? SpecHandle.Data->GetDuration() : 0.f;
+}
+
+UModularAbilitySystemComponent* UModularGameplayAbility::GetCooldownLedgerAbilitySystem(const FGameplayAbilityActorInfo* ActorInfo) const
+{
+	UModularAbilitySystemComponent* ModularASC = ActorInfo ? Cast<UModularAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) : nullptr;
+	return (ModularASC && ModularASC->IsUsingCooldownLedger()) ? ModularASC : nullptr;
+}
+
+void UModularGameplayAbility::ApplyLedgerCooldown(
+	UModularAbilitySystemComponent* AbilitySystem,
+	const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo,
+	const FGameplayAbilityActivationInfo& ActivationInfo,
+	const FGameplayTagContainer& CooldownTags,
+	float Duration) const
+{
+	check(AbilitySystem);
+
+	if (CooldownTags.IsEmpty() || Duration <= 0.f)
+	{
+		return;
+	}
+
+	AbilitySystem->ApplyLedgerCooldown(CooldownTags, Duration, ActivationInfo.GetActivationPredictionKey());
+	NotifyCooldownApplied(Handle, ActorInfo, Duration, CooldownTags);
+}
+
+void UModularGameplayAbility::NotifyCooldownApplied(
+	const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo,
+	float Duration,
+	const FGameplayTagContainer& CooldownTags) const
+{
+	// Keep the cooldown cache of the owner up to date, so polling the remaining cooldown doesn't need to query any effects
+	if (UModularAbilitySystemComponent* ModularASC = ActorInfo ? Cast<UModularAbilitySystemComponent>(ActorInfo->AbilitySystemComponent.Get()) : nullptr)
+	{
+		ModularASC->RecordAbilityCooldown(Handle, Duration, CooldownTags);
+	}
+
+	// Let others know we applied a cooldown
+	OnApplyCooldownDelegate.Broadcast(this, Duration, CooldownTags);
+}
+
 const FGameplayTagContainer* UModularGameplayAbility::GetCooldownTags() const
 {
-	// Gosh, this really isn't thread safe, is it?
-	static FGameplayTagContainer LocalCooldownTags;
-	LocalCooldownTags.Reset();
-	if (UGameplayEffect* CDGE = GetCooldownGameplayEffect())
+	// The tags only depend on class defaults and the level, so all instances share the containers of the CDO
+	const UModularGameplayAbility* AbilityCDO = GetClass()->GetDefaultObject<UModularGameplayAbility>();
+	return AbilityCDO->GetCooldownTagsForLevel(GetAbilityLevel());
+}
+
+const FGameplayTagContainer* UModularGameplayAbility::GetCooldownTagsForLevel(int32 AbilityLevel) const
+{
 	{
-		LocalCooldownTags.AppendTags(CDGE->GetGrantedTags());
+		FReadScopeLock ReadLock(CooldownTagsLock);
+		if (const TUniquePtr<FGameplayTagContainer>* CooldownTags = CooldownTagsByLevel.Find(AbilityLevel))
+		{
+			return CooldownTags->Get();
+		}
 	}
 
-	if (ExplicitCooldownDuration.GetValueAtLevel(GetAbilityLevel()) > 0.0f)
+	TUniquePtr<FGameplayTagContainer> NewCooldownTags = MakeUnique<FGameplayTagContainer>();
+	BuildCooldownTagsForLevel(AbilityLevel, *NewCooldownTags);
+
+	FWriteScopeLock WriteLock(CooldownTagsLock);
+
+	// Another thread may have built the same level in the meantime
+	TUniquePtr<FGameplayTagContainer>& CooldownTags = CooldownTagsByLevel.FindOrAdd(AbilityLevel);
+	if (!CooldownTags.IsValid())
 	{
-		LocalCooldownTags.AppendTags(ExplicitCooldownTags);
+		CooldownTags = MoveTemp(NewCooldownTags);
 	}
 
-	return &LocalCooldownTags;
+	return CooldownTags.Get();
+}
+
+void UModularGameplayAbility::BuildCooldownTagsForLevel(int32 AbilityLevel, FGameplayTagContainer& OutCooldownTags) const
+{
+	if (UGameplayEffect* CDGE = GetCooldownGameplayEffect())
+	{
+		OutCooldownTags.AppendTags(CDGE->GetGrantedTags());
+	}
+
+	if (ExplicitCooldownDuration.GetValueAtLevel(AbilityLevel) > 0.0f)
+	{
+		OutCooldownTags.AppendTags(ExplicitCooldownTags);
+	}
 }
 
 void UModularGameplayAbility::OnPawnAvatarSet()
@@ -1156,6 +1451,62 @@ void UModularGameplayAbility::OnPawnAvatarSet()
 	K2_OnPawnAvatarSet();
 }
 
+FGameplayEffectSpecHandle UModularGameplayAbility::MakeExplicitCooldownSpec(const UGameplayEffect* CooldownEffectCDO, int32 AbilityLevel) const
+{
+	const FGameplayEffectSpecHandle CooldownSpecHandle = MakeOutgoingGameplayEffectSpec(CooldownEffectCDO->GetClass(), AbilityLevel);
+	if (!CooldownSpecHandle.IsValid())
+	{
+		return CooldownSpecHandle;
+	}
+
+	CooldownSpecHandle.Data->AppendDynamicAssetTags(ExplicitCooldownAssetTags);
+	CooldownSpecHandle.Data->DynamicGrantedTags.AppendTags(ExplicitCooldownTags);
+
+	return CooldownSpecHandle;
+}
+
+FGameplayEffectSpecHandle UModularGameplayAbility::MakeCooldownSpecFromTemplate(
+	const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo,
+	const UGameplayEffect* CooldownEffectCDO,
+	int32 AbilityLevel) const
+{
+	// Non-instanced abilities are shared between actors, so they always build their spec from scratch.
+	// Effects with modifiers or executions compute magnitudes when the spec is made, which a copy would keep stale.
+	UAbilitySystemComponent* AbilitySystem = ActorInfo ? ActorInfo->AbilitySystemComponent.Get() : nullptr;
+	const bool bCanUseTemplate = AbilitySystem && IsInstantiated() && CooldownEffectCDO->Modifiers.IsEmpty() && CooldownEffectCDO->Executions.IsEmpty();
+	if (!bCanUseTemplate)
+	{
+		return MakeExplicitCooldownSpec(CooldownEffectCDO, AbilityLevel);
+	}
+
+	FGameplayEffectSpecHandle& Template = CooldownSpecTemplates.FindOrAdd(AbilityLevel);
+	if (!Template.IsValid() || Template.Data->Def != CooldownEffectCDO)
+	{
+		Template = MakeExplicitCooldownSpec(CooldownEffectCDO, AbilityLevel);
+		if (!Template.IsValid())
+		{
+			return Template;
+		}
+	}
+
+	FGameplayEffectSpecHandle CooldownSpecHandle(new FGameplayEffectSpec(*Template.Data));
+	FGameplayEffectSpec& CooldownSpec = *CooldownSpecHandle.Data;
+
+	// Same state MakeOutgoingGameplayEffectSpec captures for every activation.
+	// Setting a new context recaptures the source actor tags and the source attributes.
+	CooldownSpec.SetContext(MakeEffectContext(Handle, ActorInfo));
+
+	FGameplayAbilitySpec* AbilitySpec = AbilitySystem->FindAbilitySpecFromHandle(Handle);
+	CooldownSpec.CapturedSourceTags.GetSpecTags().Reset();
+	ApplyAbilityTagsToGameplayEffectSpec(CooldownSpec, AbilitySpec);
+
+	CooldownSpec.SetByCallerTagMagnitudes = AbilitySpec ? AbilitySpec->SetByCallerTagMagnitudes : TMap<FGameplayTag, float>();
+	CooldownSpec.SetByCallerNameMagnitudes.Reset();
+
+	return CooldownSpecHandle;
+}
+
 void UModularGameplayAbility::NativeOnAbilityFailedToActivate(const FGameplayTagContainer& FailedReason) const
 {
 	bool bSimpleFailureFound = false;
@@ -1186,4 +1537,22 @@ PRAGMA_ENABLE_DEPRECATION_WARNINGS
 
 	return Result;
 }
+
+void UModularGameplayAbility::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Cooldown settings may have changed. Rebuild the containers in place, as their pointers were handed out, e.g. to the cooldown cache of ability systems
+	{
+		FWriteScopeLock WriteLock(CooldownTagsLock);
+		for (TPair<int32, TUniquePtr<FGameplayTagContainer>>& Pair : CooldownTagsByLevel)
+		{
+			FGameplayTagContainer CooldownTags;
+			BuildCooldownTagsForLevel(Pair.Key, CooldownTags);
+			*Pair.Value = MoveTemp(CooldownTags);
+		}
+	}
+
+	CooldownSpecTemplates.Reset();
+}
 #endif
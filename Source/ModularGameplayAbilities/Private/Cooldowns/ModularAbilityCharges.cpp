@@ -0,0 +1,89 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+
+#include "Cooldowns/ModularAbilityCharges.h"
+
+#include "ModularAbilitySystemComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ModularAbilityCharges)
+
+//////////////////////////////////////////////////////////////////////////
+/// FModularAbilityChargeEntry
+
+void FModularAbilityChargeEntry::PostReplicatedAdd(const FModularAbilityChargeList& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnAbilityChargesReplicated(*this);
+	}
+}
+
+void FModularAbilityChargeEntry::PostReplicatedChange(const FModularAbilityChargeList& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnAbilityChargesReplicated(*this);
+	}
+}
+
+int32 FModularAbilityChargeEntry::GetCharges(const double Time) const
+{
+	const double MissingTime = FullyChargedTime - Time;
+	if (MissingTime <= 0.f || RechargeDuration <= 0.f)
+	{
+		return MaxCharges;
+	}
+
+	const int32 MissingCharges = FMath::CeilToInt32(MissingTime / RechargeDuration);
+	return FMath::Max(MaxCharges - MissingCharges, 0);
+}
+
+float FModularAbilityChargeEntry::GetTimeUntilNextCharge(const double Time) const
+{
+	const double MissingTime = FullyChargedTime - Time;
+	if (MissingTime <= 0.f || RechargeDuration <= 0.f)
+	{
+		return 0.f;
+	}
+
+	// All missing charges but the next one still need their full duration
+	const int32 MissingCharges = FMath::CeilToInt32(MissingTime / RechargeDuration);
+	return static_cast<float>(MissingTime - (MissingCharges - 1) * RechargeDuration);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// FModularAbilityChargeList
+
+void FModularAbilityChargeList::Set(const FModularAbilityChargeEntry& NewEntry)
+{
+	FModularAbilityChargeEntry* Entry = Entries.FindByPredicate([&NewEntry](const FModularAbilityChargeEntry& Other)
+	{
+		return Other.Handle == NewEntry.Handle;
+	});
+
+	if (Entry)
+	{
+		Entry->MaxCharges = NewEntry.MaxCharges;
+		Entry->RechargeDuration = NewEntry.RechargeDuration;
+		Entry->FullyChargedTime = NewEntry.FullyChargedTime;
+	}
+	else
+	{
+		Entry = &Entries.Add_GetRef(NewEntry);
+	}
+
+	MarkItemDirty(*Entry);
+}
+
+void FModularAbilityChargeList::Remove(const FGameplayAbilitySpecHandle& Handle)
+{
+	const int32 NumRemoved = Entries.RemoveAllSwap([&Handle](const FModularAbilityChargeEntry& Entry)
+	{
+		return Entry.Handle == Handle;
+	});
+
+	if (NumRemoved > 0)
+	{
+		MarkArrayDirty();
+	}
+}
@@ -0,0 +1,97 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+
+#include "Cooldowns/ModularCooldownLedger.h"
+
+#include "ModularAbilitySystemComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ModularCooldownLedger)
+
+//////////////////////////////////////////////////////////////////////////
+/// FModularCooldownEntry
+
+void FModularCooldownEntry::PostReplicatedAdd(const FModularCooldownLedger& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnCooldownLedgerEntryReplicated(*this);
+	}
+}
+
+void FModularCooldownEntry::PostReplicatedChange(const FModularCooldownLedger& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnCooldownLedgerEntryReplicated(*this);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// FModularCooldownLedger
+
+void FModularCooldownLedger::SetCooldown(const FGameplayTag& CooldownTag, const double EndTime, const float Duration)
+{
+	FModularCooldownEntry* Entry = Entries.FindByPredicate([&CooldownTag](const FModularCooldownEntry& Other)
+	{
+		return Other.CooldownTag == CooldownTag;
+	});
+
+	if (Entry)
+	{
+		Entry->EndTime = EndTime;
+		Entry->Duration = Duration;
+	}
+	else
+	{
+		Entry = &Entries.Emplace_GetRef(CooldownTag, EndTime, Duration);
+	}
+
+	MarkItemDirty(*Entry);
+}
+
+void FModularCooldownLedger::RemoveCooldown(const FGameplayTag& CooldownTag)
+{
+	const int32 NumRemoved = Entries.RemoveAllSwap([&CooldownTag](const FModularCooldownEntry& Entry)
+	{
+		return Entry.CooldownTag == CooldownTag;
+	});
+
+	if (NumRemoved > 0)
+	{
+		MarkArrayDirty();
+	}
+}
+
+const FModularCooldownEntry* FModularCooldownLedger::FindLongestCooldown(const FGameplayTagContainer& CooldownTags, const double Time) const
+{
+	const FModularCooldownEntry* LongestEntry = nullptr;
+
+	for (const FModularCooldownEntry& Entry : Entries)
+	{
+		// Same as matching the owned tags granted by a cooldown effect against the cooldown tags
+		if (Entry.IsActive(Time) && Entry.CooldownTag.MatchesAny(CooldownTags))
+		{
+			if ((LongestEntry == nullptr) || (Entry.EndTime > LongestEntry->EndTime))
+			{
+				LongestEntry = &Entry;
+			}
+		}
+	}
+
+	return LongestEntry;
+}
+
+double FModularCooldownLedger::GetNextEndTime(const double Time) const
+{
+	double NextEndTime = 0.0;
+
+	for (const FModularCooldownEntry& Entry : Entries)
+	{
+		if (Entry.IsActive(Time) && ((NextEndTime == 0.0) || (Entry.EndTime < NextEndTime)))
+		{
+			NextEndTime = Entry.EndTime;
+		}
+	}
+
+	return NextEndTime;
+}
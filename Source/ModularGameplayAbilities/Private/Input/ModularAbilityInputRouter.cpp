@@ -0,0 +1,276 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+
+#include "Input/ModularAbilityInputRouter.h"
+
+#include "EnhancedInputComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "InputAction.h"
+#include "ModularAbilitySystemComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ModularAbilityInputRouter)
+
+namespace ModularAbilityInputRouter
+{
+	static constexpr ETriggerEvent RoutedTriggerEvents[] =
+	{
+		ETriggerEvent::Started,
+		ETriggerEvent::Ongoing,
+		ETriggerEvent::Triggered,
+		ETriggerEvent::Canceled,
+		ETriggerEvent::Completed
+	};
+}
+
+FDelegateHandle UModularAbilityInputRouter::Subscribe(const UInputAction* InputAction, FModularInputActionEventDelegate&& Delegate)
+{
+	if (!IsValid(InputAction) || !Delegate.IsBound())
+	{
+		return FDelegateHandle();
+	}
+
+	const FDelegateHandle Handle = Delegate.GetHandle();
+
+	// Don't touch the subscriber lists while they are being iterated
+	if (DispatchDepth > 0)
+	{
+		PendingSubscribers.Emplace(InputAction, MoveTemp(Delegate));
+		return Handle;
+	}
+
+	if (!ResolveInputComponent())
+	{
+		return FDelegateHandle();
+	}
+
+	FActionSubscribers& Subscribers = ActionSubscribers.FindOrAdd(InputAction);
+	Subscribers.Delegates.Add(MoveTemp(Delegate));
+
+	if (!Subscribers.bBound)
+	{
+		BindAction(InputAction, Subscribers);
+	}
+
+	return Handle;
+}
+
+void UModularAbilityInputRouter::Unsubscribe(const UInputAction* InputAction, FDelegateHandle Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return;
+	}
+
+	const int32 NumPendingRemoved = PendingSubscribers.RemoveAll([&Handle](const TPair<TWeakObjectPtr<const UInputAction>, FModularInputActionEventDelegate>& Pending)
+	{
+		return Pending.Value.GetHandle() == Handle;
+	});
+
+	if (NumPendingRemoved > 0)
+	{
+		return;
+	}
+
+	FActionSubscribers* Subscribers = ActionSubscribers.Find(InputAction);
+	if (!Subscribers)
+	{
+		return;
+	}
+
+	const int32 Idx = Subscribers->Delegates.IndexOfByPredicate([&Handle](const FModularInputActionEventDelegate& Delegate)
+	{
+		return Delegate.GetHandle() == Handle;
+	});
+
+	if (Idx == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (DispatchDepth > 0)
+	{
+		// Unbinding keeps the indices stable for the running dispatch
+		Subscribers->Delegates[Idx].Unbind();
+		bNeedsCompaction = true;
+	}
+	else
+	{
+		Subscribers->Delegates.RemoveAt(Idx);
+	}
+}
+
+void UModularAbilityInputRouter::Reset()
+{
+	if (UEnhancedInputComponent* InputComponent = BoundInputComponent.Get())
+	{
+		InputComponent->ClearBindingsForObject(this);
+	}
+
+	BoundInputComponent.Reset();
+	PendingSubscribers.Reset();
+
+	if (DispatchDepth > 0)
+	{
+		// The subscriber lists are being iterated, so only unbind everything and let the dispatch compact them
+		for (TPair<TWeakObjectPtr<const UInputAction>, FActionSubscribers>& Pair : ActionSubscribers)
+		{
+			Pair.Value.bBound = false;
+
+			for (FModularInputActionEventDelegate& Delegate : Pair.Value.Delegates)
+			{
+				Delegate.Unbind();
+			}
+		}
+
+		bNeedsCompaction = true;
+		bNeedsInputComponentRefresh = false;
+		return;
+	}
+
+	ActionSubscribers.Reset();
+	bNeedsCompaction = false;
+	bNeedsInputComponentRefresh = false;
+}
+
+void UModularAbilityInputRouter::RefreshInputComponent()
+{
+	// Rebinding iterates the subscriber lists, which the running dispatch is iterating as well
+	if (DispatchDepth > 0)
+	{
+		bNeedsInputComponentRefresh = true;
+		return;
+	}
+
+	ResolveInputComponent();
+}
+
+void UModularAbilityInputRouter::BeginDestroy()
+{
+	Reset();
+
+	Super::BeginDestroy();
+}
+
+UEnhancedInputComponent* UModularAbilityInputRouter::ResolveInputComponent()
+{
+	const FGameplayAbilityActorInfo* ActorInfo = GetOuterUModularAbilitySystemComponent()->AbilityActorInfo.Get();
+	const APlayerController* PC = ActorInfo ? ActorInfo->PlayerController.Get() : nullptr;
+	UEnhancedInputComponent* InputComponent = PC ? Cast<UEnhancedInputComponent>(PC->InputComponent) : nullptr;
+
+	if (InputComponent == BoundInputComponent.Get())
+	{
+		return InputComponent;
+	}
+
+	// The controller got a new input component, move all bindings over
+	if (UEnhancedInputComponent* OldInputComponent = BoundInputComponent.Get())
+	{
+		OldInputComponent->ClearBindingsForObject(this);
+	}
+
+	BoundInputComponent = InputComponent;
+
+	for (auto It = ActionSubscribers.CreateIterator(); It; ++It)
+	{
+		It->Value.bBound = false;
+
+		const UInputAction* InputAction = It->Key.Get();
+		if (!InputAction)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		BindAction(InputAction, It->Value);
+	}
+
+	return InputComponent;
+}
+
+void UModularAbilityInputRouter::BindAction(const UInputAction* InputAction, FActionSubscribers& Subscribers)
+{
+	UEnhancedInputComponent* InputComponent = BoundInputComponent.Get();
+	if (!InputComponent)
+	{
+		return;
+	}
+
+	for (const ETriggerEvent TriggerEvent : ModularAbilityInputRouter::RoutedTriggerEvents)
+	{
+		InputComponent->BindAction(InputAction, TriggerEvent, this, &ThisClass::HandleActionEvent);
+	}
+
+	Subscribers.bBound = true;
+}
+
+void UModularAbilityInputRouter::HandleActionEvent(const FInputActionInstance& ActionInstance)
+{
+	FActionSubscribers* Subscribers = ActionSubscribers.Find(ActionInstance.GetSourceAction());
+	if (!Subscribers)
+	{
+		return;
+	}
+
+	const ETriggerEvent TriggerEvent = ActionInstance.GetTriggerEvent();
+	const FInputActionValue ActionValue = ActionInstance.GetValue();
+
+	{
+		TGuardValue<int32> DispatchGuard(DispatchDepth, DispatchDepth + 1);
+
+		// New subscribers are deferred and removed ones only unbound, so the list can't change while we iterate it
+		for (int32 Idx = 0; Idx < Subscribers->Delegates.Num(); ++Idx)
+		{
+			Subscribers->Delegates[Idx].ExecuteIfBound(TriggerEvent, ActionValue);
+		}
+	}
+
+	if (DispatchDepth == 0)
+	{
+		CompactSubscribers();
+	}
+}
+
+void UModularAbilityInputRouter::CompactSubscribers()
+{
+	if (bNeedsInputComponentRefresh)
+	{
+		bNeedsInputComponentRefresh = false;
+		ResolveInputComponent();
+	}
+
+	if (bNeedsCompaction)
+	{
+		bNeedsCompaction = false;
+
+		for (TPair<TWeakObjectPtr<const UInputAction>, FActionSubscribers>& Pair : ActionSubscribers)
+		{
+			Pair.Value.Delegates.RemoveAll([](const FModularInputActionEventDelegate& Delegate)
+			{
+				return !Delegate.IsBound();
+			});
+		}
+	}
+
+	if (PendingSubscribers.Num() > 0)
+	{
+		TArray<TPair<TWeakObjectPtr<const UInputAction>, FModularInputActionEventDelegate>> NewSubscribers = MoveTemp(PendingSubscribers);
+		PendingSubscribers.Reset();
+
+		for (TPair<TWeakObjectPtr<const UInputAction>, FModularInputActionEventDelegate>& Pending : NewSubscribers)
+		{
+			const UInputAction* InputAction = Pending.Key.Get();
+			if (!InputAction)
+			{
+				continue;
+			}
+
+			FActionSubscribers& Subscribers = ActionSubscribers.FindOrAdd(InputAction);
+			Subscribers.Delegates.Add(MoveTemp(Pending.Value));
+
+			if (!Subscribers.bBound)
+			{
+				BindAction(InputAction, Subscribers);
+			}
+		}
+	}
+}
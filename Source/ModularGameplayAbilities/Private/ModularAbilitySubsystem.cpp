@@ -4,6 +4,8 @@
 #include "ModularAbilitySubsystem.h"
 
 #include "AbilitySystemLog.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ModularAbilitySubsystem)
 
@@ -84,6 +86,28 @@ void FGloballyAppliedEffects::RemoveFromAll()
 	Handles.Empty();
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// FModularAbilityInputTickFunction
+
+void FModularAbilityInputTickFunction::ExecuteTick(
+	float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (IsValid(Target))
+	{
+		Target->ProcessBatchedAbilityInput(DeltaTime);
+	}
+}
+
+FString FModularAbilityInputTickFunction::DiagnosticMessage()
+{
+	return TEXT("FModularAbilityInputTickFunction");
+}
+
+FName FModularAbilityInputTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return FName(TEXT("ModularAbilityInput"));
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// UModularAbilitySubsystem
 
@@ -105,6 +129,30 @@ bool UModularAbilitySubsystem::ShouldCreateSubsystem(UObject* Outer) const
 	return DerivedClasses.Num() == 0;
 }
 
+void UModularAbilitySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	AbilityInputTickFunction.Target = this;
+	AbilityInputTickFunction.TickGroup = BatchedAbilityInputTickGroup;
+	AbilityInputTickFunction.bCanEverTick = true;
+	AbilityInputTickFunction.bStartWithTickEnabled = bBatchAbilityInput;
+	AbilityInputTickFunction.bTickEvenWhenPaused = true; // So we can clear the input while paused
+	AbilityInputTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UModularAbilitySubsystem::Deinitialize()
+{
+	if (AbilityInputTickFunction.IsTickFunctionRegistered())
+	{
+		AbilityInputTickFunction.UnRegisterTickFunction();
+	}
+
+	AbilityInputTickFunction.Target = nullptr;
+
+	Super::Deinitialize();
+}
+
 UModularAbilitySubsystem* UModularAbilitySubsystem::Get(const UObject* WorldContextObject)
 {
 	return WorldContextObject ? WorldContextObject->GetWorld()->GetSubsystem<UModularAbilitySubsystem>() : nullptr;
@@ -131,6 +179,9 @@ void UModularAbilitySubsystem::RegisterAbilitySystem(UModularAbilitySystemCompon
 	}
 
 	RegisteredAbilitySystems.AddUnique(AbilitySystem);
+	AbilitySystem->bAbilityInputBatched = bBatchAbilityInput;
+
+	AddAbilityInputPrerequisite(AbilitySystem);
 }
 
 void UModularAbilitySubsystem::UnregisterAbilitySystem(UModularAbilitySystemComponent* AbilitySystem)
@@ -148,6 +199,38 @@ void UModularAbilitySubsystem::UnregisterAbilitySystem(UModularAbilitySystemComp
 	}
 
 	RegisteredAbilitySystems.Remove(AbilitySystem);
+	AbilitySystem->bAbilityInputBatched = false;
+
+	RemoveAbilityInputPrerequisite(AbilitySystem);
+}
+
+void UModularAbilitySubsystem::AddAbilityInputPrerequisite(UModularAbilitySystemComponent* AbilitySystem)
+{
+	APlayerController* PC = AbilitySystem->AbilityActorInfo.IsValid() ? AbilitySystem->AbilityActorInfo->PlayerController.Get() : nullptr;
+	if (PC && PC->IsLocalController())
+	{
+		// Enhanced input fires its events from the player controller's tick. Already added prerequisites are ignored
+		AbilityInputTickFunction.AddPrerequisite(PC, PC->PrimaryActorTick);
+	}
+}
+
+void UModularAbilitySubsystem::RemoveAbilityInputPrerequisite(UModularAbilitySystemComponent* AbilitySystem)
+{
+	APlayerController* PC = AbilitySystem->AbilityActorInfo.IsValid() ? AbilitySystem->AbilityActorInfo->PlayerController.Get() : nullptr;
+	if (!PC)
+	{
+		return;
+	}
+
+	for (const UModularAbilitySystemComponent* Other : RegisteredAbilitySystems)
+	{
+		if (IsValid(Other) && Other->AbilityActorInfo.IsValid() && (Other->AbilityActorInfo->PlayerController.Get() == PC))
+		{
+			return;
+		}
+	}
+
+	AbilityInputTickFunction.RemovePrerequisite(PC, PC->PrimaryActorTick);
 }
 
 void UModularAbilitySubsystem::ApplyAbilityToAll(TSubclassOf<UGameplayAbility> Ability)
@@ -217,3 +300,58 @@ void UModularAbilitySubsystem::RemoveEffectFromAll(TSubclassOf<UGameplayEffect>
 		GloballyAppliedEffects.Remove(Effect);
 	}
 }
+
+void UModularAbilitySubsystem::SetBatchAbilityInput(bool bEnabled)
+{
+	if (bBatchAbilityInput == bEnabled)
+	{
+		return;
+	}
+
+	bBatchAbilityInput = bEnabled;
+
+	for (UModularAbilitySystemComponent* AbilitySystem : RegisteredAbilitySystems)
+	{
+		if (IsValid(AbilitySystem))
+		{
+			AbilitySystem->bAbilityInputBatched = bEnabled;
+		}
+	}
+
+	if (AbilityInputTickFunction.IsTickFunctionRegistered())
+	{
+		AbilityInputTickFunction.SetTickFunctionEnable(bEnabled);
+	}
+}
+
+void UModularAbilitySubsystem::ProcessBatchedAbilityInput(float DeltaTime)
+{
+	if (!bBatchAbilityInput)
+	{
+		return;
+	}
+
+	const UWorld* World = GetWorld();
+	const bool bGamePaused = World && World->IsPaused();
+
+	// Processing input may end up registering or unregistering ability systems, so iterate a copy
+	BatchedAbilitySystems.Reset();
+	BatchedAbilitySystems.Append(RegisteredAbilitySystems);
+
+	for (UModularAbilitySystemComponent* AbilitySystem : BatchedAbilitySystems)
+	{
+		if (!IsValid(AbilitySystem) || !AbilitySystem->bAbilityInputBatched)
+		{
+			continue;
+		}
+
+		if (!AbilitySystem->HasPendingAbilityInput())
+		{
+			continue;
+		}
+
+		AbilitySystem->ProcessAbilityInputInternal(DeltaTime, bGamePaused);
+	}
+
+	BatchedAbilitySystems.Reset();
+}
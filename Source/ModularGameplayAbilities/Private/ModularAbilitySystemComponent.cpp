@@ -1,24 +1,83 @@
-// Author: Tom Werner (MajorT), 2025
+﻿// Author: Tom Werner (MajorT), 2025
 
 
 #include "ModularAbilitySystemComponent.h"
 
 #include "AbilitySystemLog.h"
+#include "GameplayEffect.h"
 #include "ModularAbilitySubsystem.h"
 #include "ModularAbilityTagRelationshipMapping.h"
 #include "ModularGameplayAbilitiesSettings.h"
 #include "Abilities/ModularGameplayAbility.h"
+#include "Abilities/Costs/ModularAbilityCost.h"
+#include "Input/ModularAbilityInputRouter.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ModularAbilitySystemComponent)
 
+namespace ModularAbilitySystem
+{
+	/** Returns the dynamic tags of the spec, which is where the input tags are stored. */
+	static const FGameplayTagContainer& GetSpecInputTags(const FGameplayAbilitySpec& Spec)
+	{
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 5
+		return Spec.GetDynamicSpecSourceTags();
+#else
+		return Spec.DynamicAbilityTags;
+#endif
+	}
+
+	/** Returns true if the spec's ability is allowed to be activated by input. */
+	static bool DoesSpecReceiveInput(const FGameplayAbilitySpec& Spec)
+	{
+		const UModularGameplayAbility* CDO = Cast<UModularGameplayAbility>(Spec.Ability);
+		if (CDO == nullptr)
+		{
+			return false;
+		}
+
+		return (CDO->GetActivationPolicy() == EGameplayAbilityActivationPolicy::Active) || CDO->IsForceReceiveInput();
+	}
+}
+
 UModularAbilitySystemComponent::UModularAbilitySystemComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
-	InputHeldHandles.Reset();
-	InputPressedHandles.Reset();
-	InputReleasedHandles.Reset();
+	InputHeldSlots.Reset();
+	InputPressedSlots.Reset();
+	InputReleasedSlots.Reset();
 
 	FMemory::Memset(ActivationGroupCounts, 0 , sizeof(ActivationGroupCounts));
+
+	// The input mode requires a restart to change, so we only need to resolve it once
+	bUseAlterAbilityInput = UModularGameplayAbilitiesSettings::IsUsingAlterAbilityInput();
+	bAbilitySpecIndicesDirty = true;
+	bAbilityInputBatched = false;
+	bBufferedAbilityInputRetryPending = false;
+	bReplicatedInputFlushPending = false;
+	bActivatableSpecsDirty = true;
+	bStateSnapshotPublishPending = false;
+	bSnapshotAttributesBound = false;
+	bPublishStateSnapshot = false;
+	bUseCooldownLedger = false;
+
+	CooldownLedger.Owner = this;
+	AbilityCharges.Owner = this;
+
+	OnAnyGameplayEffectRemovedDelegate().AddUObject(this, &ThisClass::OnCooldownEffectRemoved);
+}
+
+void UModularAbilitySystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = COND_ReplayOrOwner;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, CooldownLedger, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, AbilityCharges, Params);
 }
 
 void UModularAbilitySystemComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -32,6 +91,18 @@ void UModularAbilitySystemComponent::EndPlay(const EEndPlayReason::Type EndPlayR
 		}
 	}
 
+	if (InputRouter)
+	{
+		InputRouter->Reset();
+	}
+
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(CooldownExpiryTimer);
+	}
+
+	UnbindSnapshotAttributes();
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -63,12 +134,14 @@ bool UModularAbilitySystemComponent::IsActivationGroupBlocked(EGameplayAbilityAc
 }
 
 void UModularAbilitySystemComponent::AddAbilityToActivationGroup(
-	EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* Ability)
+	EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)
 {
 	check(Ability);
 	check(ActivationGroupCounts[(uint8)Group] < INT32_MAX);
 
 	ActivationGroupCounts[(uint8)Group]++;
+	ActivationGroupAbilities[(uint8)Group].Emplace(Ability, Handle.IsValid() ? Handle : Ability->GetCurrentAbilitySpecHandle());
+	MarkActivatableAbilitiesDirty();
 
 	const bool bReplicateCancelAbility = false;
 
@@ -97,28 +170,91 @@ void UModularAbilitySystemComponent::AddAbilityToActivationGroup(
 }
 
 void UModularAbilitySystemComponent::RemoveAbilityFromActivationGroup(
-	EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* Ability)
+	EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)
 {
 	check(Ability);
 	check(ActivationGroupCounts[(uint8)Group] > 0);
 
 	ActivationGroupCounts[(uint8)Group]--;
+	MarkActivatableAbilitiesDirty();
+
+	// Non-instanced abilities share the CDO between specs, so the entry has to match the handle as well
+	TArray<FModularActivationGroupEntry, TInlineAllocator<2>>& GroupAbilities = ActivationGroupAbilities[(uint8)Group];
+	if (!Handle.IsValid())
+	{
+		Handle = Ability->GetCurrentAbilitySpecHandle();
+	}
+
+	const int32 Idx = GroupAbilities.IndexOfByPredicate([Ability, &Handle](const FModularActivationGroupEntry& Entry)
+	{
+		return (Entry.Ability.Get() == Ability) && (Entry.Handle == Handle);
+	});
+
+	if (Idx != INDEX_NONE)
+	{
+		GroupAbilities.RemoveAt(Idx);
+	}
+	else
+	{
+		GroupAbilities.RemoveAll([Ability](const FModularActivationGroupEntry& Entry)
+		{
+			return !Entry.Ability.IsValid() || (Entry.Ability.Get() == Ability);
+		});
+	}
 }
 
 void UModularAbilitySystemComponent::CancelActivationGroupAbilities(
 	EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* AbilityToIgnore, bool bReplicateCancelAbilities)
 {
-	auto ShouldCancelFunc = [this, Group, AbilityToIgnore](const UModularGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)
+	ABILITYLIST_SCOPE_LOCK();
+
+	// Canceling removes the abilities from the group, so iterate a copy
+	const TArray<FModularActivationGroupEntry, TInlineAllocator<2>> GroupAbilities = ActivationGroupAbilities[(uint8)Group];
+
+	for (const FModularActivationGroupEntry& Entry : GroupAbilities)
 	{
-		return ((Ability->GetActivationGroup() == Group) && (Ability != AbilityToIgnore));
-	};
+		UModularGameplayAbility* Ability = Entry.Ability.Get();
+		if (!Ability || (Ability == AbilityToIgnore))
+		{
+			continue;
+		}
+
+		// The ability may have changed its group in response to one of the previous cancellations
+		if (Ability->GetActivationGroup() != Group)
+		{
+			continue;
+		}
 
-	CancelAbilitiesByFunc(ShouldCancelFunc, bReplicateCancelAbilities);
+		if (Ability->HasAnyFlags(RF_ClassDefaultObject))
+		{
+			// CDO can always be canceled
+			check(Ability->CanBeCanceled());
+			Ability->CancelAbility(Entry.Handle, AbilityActorInfo.Get(), FGameplayAbilityActivationInfo(), bReplicateCancelAbilities);
+			continue;
+		}
+
+		if (!Ability->IsActive())
+		{
+			continue;
+		}
+
+		if (Ability->CanBeCanceled())
+		{
+			Ability->CancelAbility(Entry.Handle, AbilityActorInfo.Get(), Ability->GetCurrentActivationInfo(), bReplicateCancelAbilities);
+		}
+		else
+		{
+			ABILITY_LOG(Error, TEXT("%hs: Can't cancel ability [%s] because CanBeCanceled() is false."), __func__, *Ability->GetName());
+		}
+	}
 }
 
 void UModularAbilitySystemComponent::SetTagRelationshipMapping(UModularAbilityTagRelationshipMapping* NewMapping)
 {
 	TagRelationshipMapping = NewMapping;
+
+	// Swapping stays a pointer swap. The mapping resolves single ability tags when it compiles and everything else on first lookup.
+	ActivationTagRequirementsCache.Reset();
 }
 
 void UModularAbilitySystemComponent::ClearTagRelationshipMapping()
@@ -129,6 +265,7 @@ void UModularAbilitySystemComponent::ClearTagRelationshipMapping()
 	}
 
 	TagRelationshipMapping = nullptr;
+	ActivationTagRequirementsCache.Reset();
 }
 
 void UModularAbilitySystemComponent::GetAdditionalActivationTagRequirements(
@@ -142,6 +279,38 @@ void UModularAbilitySystemComponent::GetAdditionalActivationTagRequirements(
 	}
 }
 
+const FModularAbilityActivationTagRequirements& UModularAbilitySystemComponent::GetActivationTagRequirements(
+	const UModularGameplayAbility* Ability) const
+{
+	check(Ability);
+
+	// The mapping got recompiled, so the expanded tags may be outdated
+	const uint32 MappingSerial = TagRelationshipMapping ? TagRelationshipMapping->GetCompileSerial() : 0;
+	if (MappingSerial != ActivationTagRequirementsSerial)
+	{
+		ActivationTagRequirementsCache.Reset();
+		ActivationTagRequirementsSerial = MappingSerial;
+	}
+
+	const TObjectKey<UClass> AbilityClass(Ability->GetClass());
+	if (const FModularAbilityActivationTagRequirements* Requirements = ActivationTagRequirementsCache.Find(AbilityClass))
+	{
+		return *Requirements;
+	}
+
+	FModularAbilityActivationTagRequirements& Requirements = ActivationTagRequirementsCache.Add(AbilityClass);
+	Requirements.RequiredTags = Ability->ActivationRequiredTags;
+	Requirements.BlockedTags = Ability->ActivationBlockedTags;
+
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 5
+	GetAdditionalActivationTagRequirements(Ability->GetAssetTags(), Requirements.RequiredTags, Requirements.BlockedTags);
+#else
+	GetAdditionalActivationTagRequirements(Ability->AbilityTags, Requirements.RequiredTags, Requirements.BlockedTags);
+#endif
+
+	return Requirements;
+}
+
 FGameplayAbilitySpecHandle UModularAbilitySystemComponent::GetTrackedActorsForAbility(
 	const UGameplayAbility* Ability,
 	TArray<FAbilityTrackedActorEntry>& OutTrackedActors) const
@@ -428,14 +597,105 @@ void UModularAbilitySystemComponent::AbilitySpecInputReleased(FGameplayAbilitySp
 	}
 }
 
+void UModularAbilitySystemComponent::QueueReplicatedInputEvent(
+	const FGameplayAbilitySpecHandle Handle,
+	const FPredictionKey& OriginalPredictionKey,
+	const FPredictionKey& CurrentPredictionKey,
+	bool bPressed)
+{
+	PendingReplicatedInputEvents.Emplace(Handle, OriginalPredictionKey, CurrentPredictionKey, bPressed);
+
+	// Events nobody flushed are sent on the next tick at the latest
+	UWorld* World = GetWorld();
+	if (!bReplicatedInputFlushPending && World)
+	{
+		bReplicatedInputFlushPending = true;
+		World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &ThisClass::FlushReplicatedInputEvents));
+	}
+}
+
+void UModularAbilitySystemComponent::FlushReplicatedInputEvents()
+{
+	bReplicatedInputFlushPending = false;
+
+	if (PendingReplicatedInputEvents.IsEmpty())
+	{
+		return;
+	}
+
+	ServerSetReplicatedInputEvents(PendingReplicatedInputEvents);
+	PendingReplicatedInputEvents.Reset();
+}
+
+void UModularAbilitySystemComponent::CallServerTryActivateAbility(
+	FGameplayAbilitySpecHandle AbilityToActivate, bool InputPressed, FPredictionKey PredictionKey)
+{
+	// Keep queued input events ahead of any activation the server receives after them
+	FlushReplicatedInputEvents();
+
+	Super::CallServerTryActivateAbility(AbilityToActivate, InputPressed, PredictionKey);
+}
+
+void UModularAbilitySystemComponent::CallServerEndAbility(
+	FGameplayAbilitySpecHandle AbilityToEnd, FGameplayAbilityActivationInfo ActivationInfo, FPredictionKey PredictionKey)
+{
+	FlushReplicatedInputEvents();
+
+	Super::CallServerEndAbility(AbilityToEnd, ActivationInfo, PredictionKey);
+}
+
+void UModularAbilitySystemComponent::CallServerSetReplicatedTargetData(
+	FGameplayAbilitySpecHandle AbilityHandle,
+	FPredictionKey AbilityOriginalPredictionKey,
+	const FGameplayAbilityTargetDataHandle& ReplicatedTargetDataHandle,
+	FGameplayTag ApplicationTag,
+	FPredictionKey CurrentPredictionKey)
+{
+	FlushReplicatedInputEvents();
+
+	Super::CallServerSetReplicatedTargetData(AbilityHandle, AbilityOriginalPredictionKey, ReplicatedTargetDataHandle, ApplicationTag, CurrentPredictionKey);
+}
+
+void UModularAbilitySystemComponent::LocalInputConfirm()
+{
+	// Tasks waiting for the confirmation send their RPCs from within the callbacks
+	FlushReplicatedInputEvents();
+
+	Super::LocalInputConfirm();
+}
+
+void UModularAbilitySystemComponent::LocalInputCancel()
+{
+	FlushReplicatedInputEvents();
+
+	Super::LocalInputCancel();
+}
+
+void UModularAbilitySystemComponent::ServerSetReplicatedInputEvents_Implementation(
+	const TArray<FModularReplicatedInputEvent>& InputEvents)
+{
+	for (const FModularReplicatedInputEvent& InputEvent : InputEvents)
+	{
+		const EAbilityGenericReplicatedEvent::Type EventType =
+			InputEvent.bPressed
+			? EAbilityGenericReplicatedEvent::InputPressed
+			: EAbilityGenericReplicatedEvent::InputReleased;
+
+		// Same as ServerSetReplicatedEvent, but for every bundled event
+		FScopedPredictionWindow ScopedPrediction(this, InputEvent.CurrentPredictionKey);
+		InvokeReplicatedEvent(EventType, InputEvent.Handle, InputEvent.OriginalPredictionKey, InputEvent.CurrentPredictionKey);
+	}
+}
+
 void UModularAbilitySystemComponent::NotifyAbilityActivated(
 	const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability)
 {
 	Super::NotifyAbilityActivated(Handle, Ability);
+	MarkActivatableAbilitiesDirty();
 
 	if (UModularGameplayAbility* ModularAbility = Cast<UModularGameplayAbility>(Ability))
 	{
-		AddAbilityToActivationGroup(ModularAbility->GetActivationGroup(), ModularAbility);
+		AddAbilityToActivationGroup(ModularAbility->GetActivationGroup(), ModularAbility, Handle);
 	}
 }
 
@@ -478,10 +738,17 @@ void UModularAbilitySystemComponent::NotifyAbilityEnded(
 	FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled)
 {
 	Super::NotifyAbilityEnded(Handle, Ability, bWasCancelled);
+	MarkActivatableAbilitiesDirty();
 
 	if (UModularGameplayAbility* ModularAbility = Cast<UModularGameplayAbility>(Ability))
 	{
-		RemoveAbilityFromActivationGroup(ModularAbility->GetActivationGroup(), ModularAbility);
+		RemoveAbilityFromActivationGroup(ModularAbility->GetActivationGroup(), ModularAbility, Handle);
+	}
+
+	// The ended ability may have been what blocked the buffered input
+	if (!BufferedAbilityInputs.IsEmpty())
+	{
+		ScheduleBufferedAbilityInputRetry();
 	}
 }
 
@@ -491,9 +758,23 @@ void UModularAbilitySystemComponent::InitAbilityActorInfo(AActor* InOwnerActor,
 	check(ActorInfo);
 	check(InOwnerActor);
 
-	const bool bHasNewPawnAvatar = Cast<APawn>(InAvatarActor) && (InAvatarActor != ActorInfo->AvatarActor);
+	const bool bHasNewAvatar = InAvatarActor != ActorInfo->AvatarActor;
+	const bool bHasNewPawnAvatar = bHasNewAvatar && Cast<APawn>(InAvatarActor);
+
+	// The attribute sets may come with the avatar, so bind again on the next publish
+	if (bHasNewAvatar)
+	{
+		UnbindSnapshotAttributes();
+	}
 
 	Super::InitAbilityActorInfo(InOwnerActor, InAvatarActor);
+	MarkActivatableAbilitiesDirty();
+
+	// Possession or a new player controller may come with another input component
+	if (InputRouter)
+	{
+		InputRouter->RefreshInputComponent();
+	}
 
 	if (!bHasNewPawnAvatar)
 	{
@@ -551,10 +832,33 @@ void UModularAbilitySystemComponent::ApplyAbilityBlockAndCancelTags(
 	Super::ApplyAbilityBlockAndCancelTags(AbilityTags, RequestingAbility, bEnableBlockTags, BlockTagsCopy, bExecuteCancelTags, CancelTagsCopy);
 }
 
+void UModularAbilitySystemComponent::BlockAbilitiesWithTags(const FGameplayTagContainer& Tags)
+{
+	Super::BlockAbilitiesWithTags(Tags);
+
+	// Blocked tags are kept apart from the owned tags, so OnTagUpdated doesn't see them
+	MarkActivatableAbilitiesDirty();
+}
+
+void UModularAbilitySystemComponent::UnBlockAbilitiesWithTags(const FGameplayTagContainer& Tags)
+{
+	Super::UnBlockAbilitiesWithTags(Tags);
+
+	MarkActivatableAbilitiesDirty();
+}
+
 void UModularAbilitySystemComponent::OnGiveAbility(FGameplayAbilitySpec& AbilitySpec)
 {
 	Super::OnGiveAbility(AbilitySpec);
 
+	InvalidateAbilitySpecIndices();
+	AllocateAbilitySpecSlot(AbilitySpec.Handle);
+	AddAbilitySpecToInputBindings(AbilitySpec);
+	AddAbilitySpecToRequiredTagWatchers(AbilitySpec);
+	AddAbilitySpecToCooldownGroup(AbilitySpec);
+	WatchAbilityCostAttributes(AbilitySpec);
+	MarkActivatableAbilitiesDirty();
+
 	OnAbilityAddedEvent.Broadcast(Cast<UModularGameplayAbility>(AbilitySpec.GetPrimaryInstance()));
 }
 
@@ -562,171 +866,1224 @@ void UModularAbilitySystemComponent::OnRemoveAbility(FGameplayAbilitySpec& Abili
 {
 	Super::OnRemoveAbility(AbilitySpec);
 
+	// The spec is removed from the array right after this, which may also move another spec into its place
+	InvalidateAbilitySpecIndices();
+	RemoveAbilitySpecFromInputBindings(AbilitySpec.Handle);
+	ReleaseAbilitySpecSlot(AbilitySpec.Handle);
+	RemoveAbilitySpecFromRequiredTagWatchers(AbilitySpec.Handle);
+	RemoveAbilitySpecFromCooldownGroup(AbilitySpec.Handle);
+	UnwatchAbilityCostAttributes(AbilitySpec);
+	CooldownCache.Remove(AbilitySpec.Handle);
+	MarkActivatableAbilitiesDirty();
+
+	PredictedAbilityCharges.Remove(AbilitySpec.Handle);
+	if (IsOwnerActorAuthoritative())
+	{
+		AbilityCharges.Remove(AbilitySpec.Handle);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, AbilityCharges, this);
+	}
+
 	OnAbilityRemovedEvent.Broadcast(Cast<UModularGameplayAbility>(AbilitySpec.GetPrimaryInstance()));
 }
 
-void UModularAbilitySystemComponent::TryActivateAbilitiesOnSpawn()
+void UModularAbilitySystemComponent::OnTagUpdated(const FGameplayTag& Tag, bool TagExists)
 {
-	ABILITYLIST_SCOPE_LOCK();
+	Super::OnTagUpdated(Tag, TagExists);
 
-	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	// Only called when a tag gets added or fully removed. Also covers cooldowns, which are checked through the tags granted by the cooldown effect
+	MarkActivatableAbilitiesDirty();
+
+	if (Tag.MatchesAny(CooldownCacheTags))
 	{
-		const UModularGameplayAbility* AbilityCDO = Cast<UModularGameplayAbility>(Spec.Ability);
-		if (!AbilityCDO)
-		{
-			continue;
-		}
+		InvalidateCooldownCache(MakeArrayView(&Tag, 1));
+	}
 
-		bool bAnyInstancesFound = false;
-PRAGMA_DISABLE_DEPRECATION_WARNINGS
-		if (AbilityCDO->GetInstancingPolicy() != EGameplayAbilityInstancingPolicy::NonInstanced)
-		{
-			TArray<UGameplayAbility*> Instances = Spec.GetAbilityInstances();
-			for (UGameplayAbility* Instance : Instances)
-			{
-				if (const UModularGameplayAbility* ModularInstance = Cast<UModularGameplayAbility>(Instance))
-				{
-					ModularInstance->TryActivateAbilityOnSpawn(AbilityActorInfo.Get(), Spec);
-				}
-			}
+	// Removing a tag can never satisfy a required tag, so only added tags need to be looked up
+	if (TagExists)
+	{
+		TryActivateAbilitiesWaitingForTag(Tag);
+	}
+}
 
-			bAnyInstancesFound = Instances.Num() > 0;
-		}
+const TArray<FGameplayAbilitySpecHandle>& UModularAbilitySystemComponent::GetCurrentlyActivatableAbilities() const
+{
+	UpdateActivatableSpecs();
 
-		if (!bAnyInstancesFound)
-		{
-			AbilityCDO->TryActivateAbilityOnSpawn(AbilityActorInfo.Get(), Spec);
-		}
-PRAGMA_ENABLE_DEPRECATION_WARNINGS
-	}
+	return ActivatableSpecHandles;
 }
 
-void UModularAbilitySystemComponent::GetAbilityTargetData(
-	const FGameplayAbilitySpecHandle AbilityHandle,
-	const FGameplayAbilityActivationInfo& ActivationInfo,
-	FGameplayAbilityTargetDataHandle& OutTargetDataHandle)
+bool UModularAbilitySystemComponent::IsAbilitySpecActivatable(const FGameplayAbilitySpecHandle& Handle) const
 {
-	TSharedPtr<FAbilityReplicatedDataCache> ReplicatedDataCache =
-		AbilityTargetDataMap.Find(FGameplayAbilitySpecHandleAndPredictionKey(AbilityHandle, ActivationInfo.GetActivationPredictionKey()));
+	UpdateActivatableSpecs();
 
-	if (ReplicatedDataCache.IsValid())
+	const int32 Slot = GetAbilitySpecSlot(Handle);
+	return ActivatableSpecSlots.IsValidIndex(Slot) && ActivatableSpecSlots[Slot];
+}
+
+void UModularAbilitySystemComponent::UpdateActivatableSpecs() const
+{
+	// Level and dynamic tag changes of a spec only go through MarkAbilitySpecDirty, which isn't virtual
+	if (bActivatableSpecsDirty || (ActivatableSpecsReplicationKey != ActivatableAbilities.ArrayReplicationKey))
 	{
-		OutTargetDataHandle = ReplicatedDataCache->TargetData;
+		RebuildActivatableSpecs();
 	}
 }
 
-void UModularAbilitySystemComponent::CancelAbilitiesByFunc(
-	TShouldCancelAbilityFunc ShouldCancelFunc, bool bReplicateCancelAbility)
+void UModularAbilitySystemComponent::RebuildActivatableSpecs() const
 {
-	ABILITYLIST_SCOPE_LOCK();
+	ActivatableSpecSlots.Init(false, AbilitySpecSlotHandles.Num());
+	AffordableSpecSlots.Init(false, AbilitySpecSlotHandles.Num());
+	ActivatableSpecHandles.Reset();
+	ActivatableSpecsReplicationKey = ActivatableAbilities.ArrayReplicationKey;
+	bActivatableSpecsDirty = false;
+
+	const FGameplayAbilityActorInfo* ActorInfo = AbilityActorInfo.Get();
+	if ((ActorInfo == nullptr) || !ActorInfo->AbilitySystemComponent.IsValid())
+	{
+		return;
+	}
 
-	for (const auto& Spec : ActivatableAbilities.Items)
+	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
 	{
-		if (!Spec.IsActive())
+		if (!Spec.Ability || Spec.PendingRemove)
 		{
 			continue;
 		}
 
-		UModularGameplayAbility* AbilityCDO = Cast<UModularGameplayAbility>(Spec.Ability);
-		if (!AbilityCDO)
+		const int32 Slot = GetAbilitySpecSlot(Spec.Handle);
+		if (Slot == INDEX_NONE)
 		{
 			continue;
 		}
-PRAGMA_DISABLE_DEPRECATION_WARNINGS
-		if (AbilityCDO->GetInstancingPolicy() != EGameplayAbilityInstancingPolicy::NonInstanced)
-		{
-			// Cancel all instances of the ability
-			TArray<UGameplayAbility*> Instances = Spec.GetAbilityInstances();
-			for (UGameplayAbility* Instance : Instances)
-			{
-				UModularGameplayAbility* ModularAbility = CastChecked<UModularGameplayAbility>(Instance);
 
-				if (ShouldCancelFunc(ModularAbility, Spec.Handle))
-				{
-					if (ModularAbility->CanBeCanceled())
-					{
-						ModularAbility->CancelAbility(Spec.Handle, AbilityActorInfo.Get(), ModularAbility->GetCurrentActivationInfo(), bReplicateCancelAbility);
-					}
-					else
-					{
-						ABILITY_LOG(Error, TEXT("%hs: Can't cancel ability [%s] because CanBeCanceled() is false."), __func__, *ModularAbility->GetName());
-					}
-				}
-			}
+		// Same as TryActivateAbility, instanced abilities are checked on their primary instance
+		const UGameplayAbility* PrimaryInstance = Spec.GetPrimaryInstance();
+		const UGameplayAbility* Ability = PrimaryInstance ? PrimaryInstance : Spec.Ability.Get();
+
+		if (Ability->CanActivateAbility(Spec.Handle, ActorInfo))
+		{
+			ActivatableSpecSlots[Slot] = true;
+			AffordableSpecSlots[Slot] = true;
+			ActivatableSpecHandles.Add(Spec.Handle);
 		}
 		else
 		{
-			// Cancel CDO
-			if (ShouldCancelFunc(AbilityCDO, Spec.Handle))
-			{
-				// CDO can always be canceled
-				check(AbilityCDO->CanBeCanceled());
-				AbilityCDO->CancelAbility(Spec.Handle, AbilityActorInfo.Get(), FGameplayAbilityActivationInfo(), bReplicateCancelAbility);
-			}
+			// Only needed for the state snapshot, but cheaper to answer here than for every published snapshot
+			AffordableSpecSlots[Slot] = Ability->CheckCost(Spec.Handle, ActorInfo);
 		}
-PRAGMA_ENABLE_DEPRECATION_WARNINGS
 	}
 }
 
-void UModularAbilitySystemComponent::CancelInputActivatedAbilities(bool bReplicateCancelAbility)
-{
-	auto ShouldCancelFunc = [this](const UModularGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)
-	{
-		const EGameplayAbilityActivationPolicy::Type ActivationPolicy = Ability->GetActivationPolicy();
-		return (ActivationPolicy == EGameplayAbilityActivationPolicy::Active) || Ability->IsForceReceiveInput();
-	};
-
-	CancelAbilitiesByFunc(ShouldCancelFunc, bReplicateCancelAbility);
-}
-
-void UModularAbilitySystemComponent::AbilityInputTagPressed(const FGameplayTag& InputTag)
+void UModularAbilitySystemComponent::GetAbilityCostAttributes(const FGameplayAbilitySpec& Spec, TArray<FGameplayAttribute>& OutAttributes)
 {
-	if (UModularGameplayAbilitiesSettings::IsUsingAlterAbilityInput())
+	if (!Spec.Ability)
 	{
-		checkf(false, TEXT("UModularGameplayAbilitiesSettings::IsUsingExperimentalInput() is enabled. Please use the new input system instead of the old one."));
+		return;
 	}
 
-	if (!InputTag.IsValid())
+	// Gather the attributes modified by the cost effect and the additional costs of the ability
+	if (const UGameplayEffect* CostEffect = Spec.Ability->GetCostGameplayEffect())
 	{
-		return;
+		for (const FGameplayModifierInfo& Modifier : CostEffect->Modifiers)
+		{
+			OutAttributes.AddUnique(Modifier.Attribute);
+		}
 	}
 
-	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	if (const UModularGameplayAbility* ModularAbility = Cast<UModularGameplayAbility>(Spec.Ability))
 	{
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 5
-		if (Spec.Ability && Spec.GetDynamicSpecSourceTags().HasTagExact(InputTag))
-#else
-		if (Spec.Ability && Spec.DynamicAbilityTags.HasTagExact(InputTag))
-#endif
+		for (const TInstancedStruct<FModularAbilityCost>& InstancedCost : ModularAbility->AbilityCosts)
 		{
-			UModularGameplayAbility* CDO = Cast<UModularGameplayAbility>(Spec.Ability);
-			if (CDO == nullptr)
+			if (const FModularAbilityCost* Cost = InstancedCost.GetPtr<FModularAbilityCost>())
 			{
-				continue;
+				Cost->GetCostAttributes(OutAttributes);
 			}
+		}
+	}
+}
 
-			if ((CDO->GetActivationPolicy() != EGameplayAbilityActivationPolicy::Active) &&
-				!CDO->IsForceReceiveInput())
-			{
-				continue;
-			}
+void UModularAbilitySystemComponent::WatchAbilityCostAttributes(const FGameplayAbilitySpec& Spec)
+{
+	TArray<FGameplayAttribute> CostAttributes;
+	GetAbilityCostAttributes(Spec, CostAttributes);
 
-			// If the ability is already held, don't add it again
-			// Otherwise the ability will keep activating
-			if (InputHeldHandles.Contains(Spec.Handle))
+	for (const FGameplayAttribute& Attribute : CostAttributes)
+	{
+		if (!Attribute.IsValid())
+		{
+			continue;
+		}
+
+		FModularWatchedCostAttribute& WatchedAttribute = WatchedCostAttributes.FindOrAdd(Attribute);
+		if (WatchedAttribute.NumSpecs++ == 0)
+		{
+			WatchedAttribute.DelegateHandle = GetGameplayAttributeValueChangeDelegate(Attribute).AddUObject(this, &ThisClass::OnCostAttributeChanged);
+		}
+	}
+}
+
+void UModularAbilitySystemComponent::UnwatchAbilityCostAttributes(const FGameplayAbilitySpec& Spec)
+{
+	TArray<FGameplayAttribute> CostAttributes;
+	GetAbilityCostAttributes(Spec, CostAttributes);
+
+	for (const FGameplayAttribute& Attribute : CostAttributes)
+	{
+		FModularWatchedCostAttribute* WatchedAttribute = WatchedCostAttributes.Find(Attribute);
+		if (WatchedAttribute && (--WatchedAttribute->NumSpecs <= 0))
+		{
+			// Only remove our own binding, the snapshot may watch the same attribute
+			GetGameplayAttributeValueChangeDelegate(Attribute).Remove(WatchedAttribute->DelegateHandle);
+			WatchedCostAttributes.Remove(Attribute);
+		}
+	}
+}
+
+void UModularAbilitySystemComponent::OnCostAttributeChanged(const FOnAttributeChangeData& ChangeData)
+{
+	MarkActivatableAbilitiesDirty();
+}
+
+void UModularAbilitySystemComponent::MarkActivatableAbilitiesDirty()
+{
+	bActivatableSpecsDirty = true;
+
+	// Everything that affects activation is part of the state snapshot as well
+	ScheduleStateSnapshotPublish();
+}
+
+FModularAbilitySystemSnapshotPtr UModularAbilitySystemComponent::GetStateSnapshot() const
+{
+	FReadScopeLock ReadLock(StateSnapshotLock);
+	return StateSnapshot;
+}
+
+void UModularAbilitySystemComponent::SetPublishStateSnapshot(bool bEnabled)
+{
+	bPublishStateSnapshot = bEnabled;
+
+	if (bEnabled)
+	{
+		ScheduleStateSnapshotPublish();
+	}
+	else
+	{
+		UnbindSnapshotAttributes();
+
+		FWriteScopeLock WriteLock(StateSnapshotLock);
+		StateSnapshot.Reset();
+	}
+}
+
+void UModularAbilitySystemComponent::ScheduleStateSnapshotPublish()
+{
+	if (!bPublishStateSnapshot || bStateSnapshotPublishPending)
+	{
+		return;
+	}
+
+	// All changes of a frame end up in a single snapshot
+	UWorld* World = GetWorld();
+	if (World)
+	{
+		bStateSnapshotPublishPending = true;
+		World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &ThisClass::PublishStateSnapshot));
+	}
+}
+
+void UModularAbilitySystemComponent::PublishStateSnapshot()
+{
+	bStateSnapshotPublishPending = false;
+
+	if (!bPublishStateSnapshot)
+	{
+		return;
+	}
+
+	BindSnapshotAttributes();
+
+	TSharedRef<FModularAbilitySystemSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FModularAbilitySystemSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->Version = ++StateSnapshotVersion;
+	Snapshot->WorldTime = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0;
+	Snapshot->OwnedTags = GetOwnedGameplayTags();
+	FMemory::Memcpy(Snapshot->ActivationGroupCounts, ActivationGroupCounts, sizeof(ActivationGroupCounts));
+
+	// Activation and cost come from the activatable spec cache, cooldowns from the cooldown cache
+	UpdateActivatableSpecs();
+
+	Snapshot->Specs.Reserve(ActivatableAbilities.Items.Num());
+	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	{
+		if (!Spec.Ability || Spec.PendingRemove)
+		{
+			continue;
+		}
+
+		FModularAbilitySpecSnapshot& SpecSnapshot = Snapshot->Specs.AddDefaulted_GetRef();
+		SpecSnapshot.Handle = Spec.Handle;
+		SpecSnapshot.AbilityClass = Spec.Ability->GetClass();
+		SpecSnapshot.Level = Spec.Level;
+		SpecSnapshot.bActive = Spec.IsActive();
+
+		const int32 Slot = GetAbilitySpecSlot(Spec.Handle);
+		SpecSnapshot.bActivatable = ActivatableSpecSlots.IsValidIndex(Slot) && ActivatableSpecSlots[Slot];
+		SpecSnapshot.bCostAffordable = AffordableSpecSlots.IsValidIndex(Slot) && AffordableSpecSlots[Slot];
+
+		// Cooldowns are stored as their end time, so the snapshot doesn't need to be republished while they tick down
+		float CooldownDuration = 0.f;
+		const float TimeRemaining = GetCooldownRemaining(Spec.Handle, &CooldownDuration);
+		if (TimeRemaining > 0.f)
+		{
+			SpecSnapshot.bOnCooldown = true;
+			SpecSnapshot.CooldownDuration = CooldownDuration;
+			SpecSnapshot.CooldownEndTime = Snapshot->WorldTime + TimeRemaining;
+		}
+	}
+
+	Snapshot->AttributeValues.Reserve(SnapshotAttributes.Num());
+	for (const FGameplayAttribute& Attribute : SnapshotAttributes)
+	{
+		if (Attribute.IsValid() && HasAttributeSetForAttribute(Attribute))
+		{
+			Snapshot->AttributeValues.Emplace(Attribute, GetNumericAttribute(Attribute));
+		}
+	}
+
+	FWriteScopeLock WriteLock(StateSnapshotLock);
+	StateSnapshot = Snapshot;
+}
+
+void UModularAbilitySystemComponent::OnSnapshotAttributeChanged(const FOnAttributeChangeData& ChangeData)
+{
+	ScheduleStateSnapshotPublish();
+}
+
+void UModularAbilitySystemComponent::BindSnapshotAttributes()
+{
+	if (bSnapshotAttributesBound)
+	{
+		return;
+	}
+
+	for (const FGameplayAttribute& Attribute : SnapshotAttributes)
+	{
+		if (Attribute.IsValid())
+		{
+			const FDelegateHandle DelegateHandle = GetGameplayAttributeValueChangeDelegate(Attribute).AddUObject(this, &ThisClass::OnSnapshotAttributeChanged);
+			SnapshotAttributeBindings.Emplace(Attribute, DelegateHandle);
+		}
+	}
+
+	bSnapshotAttributesBound = true;
+}
+
+void UModularAbilitySystemComponent::UnbindSnapshotAttributes()
+{
+	// Only remove our own bindings, the cost watchers may watch the same attributes
+	for (const TPair<FGameplayAttribute, FDelegateHandle>& Binding : SnapshotAttributeBindings)
+	{
+		GetGameplayAttributeValueChangeDelegate(Binding.Key).Remove(Binding.Value);
+	}
+
+	SnapshotAttributeBindings.Reset();
+	bSnapshotAttributesBound = false;
+}
+
+double UModularAbilitySystemComponent::GetCooldownLedgerTime() const
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return 0.0;
+	}
+
+	// Clients use the server time, so replicated end times don't need to be adjusted for latency
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+void UModularAbilitySystemComponent::ApplyLedgerCooldown(const FGameplayTagContainer& CooldownTags, float Duration, FPredictionKey PredictionKey)
+{
+	ApplyLedgerCooldownTags(CooldownTags.GetGameplayTagArray(), Duration, PredictionKey);
+}
+
+void UModularAbilitySystemComponent::ApplyLedgerCooldownTags(TConstArrayView<FGameplayTag> CooldownTags, float Duration, FPredictionKey PredictionKey)
+{
+	if (CooldownTags.IsEmpty() || Duration <= 0.f)
+	{
+		return;
+	}
+
+	const double Now = GetCooldownLedgerTime();
+	const bool bAuthority = IsOwnerActorAuthoritative();
+
+	// Other specs may check the same tags
+	InvalidateCooldownCache(CooldownTags);
+
+	FModularCooldownLedger& Ledger = bAuthority ? CooldownLedger : PredictedCooldownLedger;
+	for (const FGameplayTag& CooldownTag : CooldownTags)
+	{
+		Ledger.SetCooldown(CooldownTag, Now + Duration, Duration);
+	}
+
+	if (bAuthority)
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, CooldownLedger, this);
+	}
+	else if (PredictionKey.IsValidForMorePrediction())
+	{
+		// Undo the predicted cooldown if the server rejects the activation, like a predicted cooldown effect would be removed
+		PredictionKey.NewRejectedDelegate().BindUObject(this, &ThisClass::OnPredictedLedgerCooldownRejected, TArray<FGameplayTag>(CooldownTags));
+	}
+
+	MarkActivatableAbilitiesDirty();
+	ScheduleCooldownExpiry();
+}
+
+bool UModularAbilitySystemComponent::IsOnLedgerCooldown(const FGameplayTagContainer& CooldownTags) const
+{
+	if (CooldownTags.IsEmpty())
+	{
+		return false;
+	}
+
+	const double Now = GetCooldownLedgerTime();
+	return CooldownLedger.FindLongestCooldown(CooldownTags, Now) || PredictedCooldownLedger.FindLongestCooldown(CooldownTags, Now);
+}
+
+bool UModularAbilitySystemComponent::GetLedgerCooldownTimeRemaining(
+	const FGameplayTagContainer& CooldownTags, float& OutTimeRemaining, float& OutDuration) const
+{
+	OutTimeRemaining = 0.f;
+	OutDuration = 0.f;
+
+	if (CooldownTags.IsEmpty())
+	{
+		return false;
+	}
+
+	const double Now = GetCooldownLedgerTime();
+	const FModularCooldownEntry* Entry = CooldownLedger.FindLongestCooldown(CooldownTags, Now);
+	const FModularCooldownEntry* PredictedEntry = PredictedCooldownLedger.FindLongestCooldown(CooldownTags, Now);
+
+	if (PredictedEntry && (Entry == nullptr || PredictedEntry->EndTime > Entry->EndTime))
+	{
+		Entry = PredictedEntry;
+	}
+
+	if (Entry == nullptr)
+	{
+		return false;
+	}
+
+	OutTimeRemaining = static_cast<float>(Entry->EndTime - Now);
+	OutDuration = Entry->Duration;
+	return true;
+}
+
+void UModularAbilitySystemComponent::ApplyCooldownGroup(const FGameplayTag& GroupTag, float Duration, FPredictionKey PredictionKey)
+{
+	if (!GroupTag.IsValid() || Duration <= 0.f)
+	{
+		return;
+	}
+
+	// The group is a single entry of the cooldown ledger, shared by all of its members
+	ApplyLedgerCooldownTags(MakeArrayView(&GroupTag, 1), Duration, PredictionKey);
+
+	OnCooldownGroupChanged.Broadcast(GroupTag, Duration, Duration);
+}
+
+bool UModularAbilitySystemComponent::IsCooldownGroupActive(const FGameplayTag& GroupTag) const
+{
+	const double Now = GetCooldownLedgerTime();
+	return PredictedCooldownLedger.FindCooldown(GroupTag, Now) || CooldownLedger.FindCooldown(GroupTag, Now);
+}
+
+bool UModularAbilitySystemComponent::GetCooldownGroupTimeRemaining(const FGameplayTag& GroupTag, float& OutTimeRemaining, float& OutDuration) const
+{
+	OutTimeRemaining = 0.f;
+	OutDuration = 0.f;
+
+	const double Now = GetCooldownLedgerTime();
+	const FModularCooldownEntry* Entry = CooldownLedger.FindCooldown(GroupTag, Now);
+	const FModularCooldownEntry* PredictedEntry = PredictedCooldownLedger.FindCooldown(GroupTag, Now);
+
+	if (PredictedEntry && (Entry == nullptr || PredictedEntry->EndTime > Entry->EndTime))
+	{
+		Entry = PredictedEntry;
+	}
+
+	if (Entry == nullptr)
+	{
+		return false;
+	}
+
+	OutTimeRemaining = static_cast<float>(Entry->EndTime - Now);
+	OutDuration = Entry->Duration;
+	return true;
+}
+
+TConstArrayView<FGameplayAbilitySpecHandle> UModularAbilitySystemComponent::GetCooldownGroupMembers(const FGameplayTag& GroupTag) const
+{
+	const TArray<FGameplayAbilitySpecHandle, TInlineAllocator<4>>* Members = CooldownGroupMembers.Find(GroupTag);
+	return Members ? TConstArrayView<FGameplayAbilitySpecHandle>(*Members) : TConstArrayView<FGameplayAbilitySpecHandle>();
+}
+
+void UModularAbilitySystemComponent::AddAbilitySpecToCooldownGroup(const FGameplayAbilitySpec& Spec)
+{
+	const UModularGameplayAbility* CDO = Cast<UModularGameplayAbility>(Spec.Ability);
+	if (CDO == nullptr || !CDO->GetCooldownGroupTag().IsValid())
+	{
+		return;
+	}
+
+	CooldownGroupMembers.FindOrAdd(CDO->GetCooldownGroupTag()).AddUnique(Spec.Handle);
+	SpecCooldownGroups.Add(Spec.Handle, CDO->GetCooldownGroupTag());
+}
+
+void UModularAbilitySystemComponent::RemoveAbilitySpecFromCooldownGroup(const FGameplayAbilitySpecHandle& Handle)
+{
+	FGameplayTag GroupTag;
+	if (!SpecCooldownGroups.RemoveAndCopyValue(Handle, GroupTag))
+	{
+		return;
+	}
+
+	if (TArray<FGameplayAbilitySpecHandle, TInlineAllocator<4>>* Members = CooldownGroupMembers.Find(GroupTag))
+	{
+		Members->RemoveSingleSwap(Handle);
+		if (Members->IsEmpty())
+		{
+			CooldownGroupMembers.Remove(GroupTag);
+		}
+	}
+}
+
+void UModularAbilitySystemComponent::RebuildCooldownGroups()
+{
+	CooldownGroupMembers.Reset();
+	SpecCooldownGroups.Reset();
+
+	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	{
+		AddAbilitySpecToCooldownGroup(Spec);
+	}
+}
+
+void UModularAbilitySystemComponent::OnPredictedLedgerCooldownRejected(TArray<FGameplayTag> CooldownTags)
+{
+	InvalidateCooldownCache(CooldownTags);
+
+	for (const FGameplayTag& CooldownTag : CooldownTags)
+	{
+		PredictedCooldownLedger.RemoveCooldown(CooldownTag);
+
+		if (CooldownGroupMembers.Contains(CooldownTag))
+		{
+			OnCooldownGroupChanged.Broadcast(CooldownTag, 0.f, 0.f);
+		}
+	}
+
+	MarkActivatableAbilitiesDirty();
+	ScheduleCooldownExpiry();
+}
+
+void UModularAbilitySystemComponent::OnCooldownLedgerEntryReplicated(const FModularCooldownEntry& Entry)
+{
+	// The server confirmed the cooldown, so the predicted one is no longer needed
+	PredictedCooldownLedger.RemoveCooldown(Entry.CooldownTag);
+	InvalidateCooldownCache(MakeArrayView(&Entry.CooldownTag, 1));
+
+	if (CooldownGroupMembers.Contains(Entry.CooldownTag))
+	{
+		OnCooldownGroupChanged.Broadcast(Entry.CooldownTag, static_cast<float>(FMath::Max(Entry.EndTime - GetCooldownLedgerTime(), 0.0)), Entry.Duration);
+	}
+
+	MarkActivatableAbilitiesDirty();
+	ScheduleCooldownExpiry();
+}
+
+void UModularAbilitySystemComponent::ScheduleCooldownExpiry()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	const double Now = GetCooldownLedgerTime();
+
+	double EndTime = 0.0;
+	auto ConsiderEndTime = [&EndTime](const double OtherEndTime)
+	{
+		if (OtherEndTime > 0.0 && (EndTime <= 0.0 || OtherEndTime < EndTime))
+		{
+			EndTime = OtherEndTime;
+		}
+	};
+
+	ConsiderEndTime(CooldownLedger.GetNextEndTime(Now));
+	ConsiderEndTime(PredictedCooldownLedger.GetNextEndTime(Now));
+
+	// Charges only affect activation while there are none left, so only depleted specs need to wake us up
+	auto ConsiderChargeEntry = [&ConsiderEndTime, Now](const FModularAbilityChargeEntry& Entry)
+	{
+		if (Entry.GetCharges(Now) == 0)
+		{
+			ConsiderEndTime(Now + Entry.GetTimeUntilNextCharge(Now));
+		}
+	};
+
+	for (const FModularAbilityChargeEntry& Entry : AbilityCharges.Entries)
+	{
+		if (!PredictedAbilityCharges.Contains(Entry.Handle))
+		{
+			ConsiderChargeEntry(Entry);
+		}
+	}
+
+	for (const TPair<FGameplayAbilitySpecHandle, FModularAbilityChargeEntry>& Pair : PredictedAbilityCharges)
+	{
+		ConsiderChargeEntry(Pair.Value);
+	}
+
+	if (EndTime <= 0.0)
+	{
+		World->GetTimerManager().ClearTimer(CooldownExpiryTimer);
+		return;
+	}
+
+	// Ending cooldowns and recharges don't change any tags, so this is what tells the activatable abilities to be re-evaluated
+	World->GetTimerManager().SetTimer(CooldownExpiryTimer, FTimerDelegate::CreateUObject(this, &ThisClass::OnCooldownExpired), FMath::Max(static_cast<float>(EndTime - Now), UE_KINDA_SMALL_NUMBER), false);
+}
+
+void UModularAbilitySystemComponent::OnCooldownExpired()
+{
+	MarkActivatableAbilitiesDirty();
+	ScheduleCooldownExpiry();
+}
+
+float UModularAbilitySystemComponent::GetCooldownRemaining(const FGameplayAbilitySpecHandle& Handle, float* OutDuration) const
+{
+	const UWorld* World = GetWorld();
+	const double Now = World ? World->GetTimeSeconds() : 0.0;
+
+	FModularAbilityCooldownCacheEntry* Entry = CooldownCache.Find(Handle);
+	if (!Entry || Entry->bOutdated)
+	{
+		// Outdated, so ask the ability once and keep the result until its cooldown tags change again
+		const FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleCached(Handle);
+		const FGameplayAbilityActorInfo* ActorInfo = AbilityActorInfo.Get();
+
+		if (!Spec || !Spec->Ability || !ActorInfo)
+		{
+			// Don't cache anything for handles we don't know, the entry would never be removed again
+			if (OutDuration)
+			{
+				*OutDuration = 0.f;
+			}
+
+			return 0.f;
+		}
+
+		if (!Entry)
+		{
+			Entry = &CooldownCache.Add(Handle);
+		}
+
+		Entry->bOutdated = false;
+		Entry->StartTime = Now;
+		Entry->Duration = 0.f;
+
+		const UGameplayAbility* PrimaryInstance = Spec->GetPrimaryInstance();
+		const UGameplayAbility* Ability = PrimaryInstance ? PrimaryInstance : Spec->Ability.Get();
+
+		float TimeRemaining = 0.f;
+		float Duration = 0.f;
+		Ability->GetCooldownTimeRemainingAndDuration(Handle, ActorInfo, TimeRemaining, Duration);
+
+		if (TimeRemaining > 0.f)
+		{
+			Entry->StartTime = Now + TimeRemaining - Duration;
+			Entry->Duration = Duration;
+		}
+
+		const UModularGameplayAbility* ModularCDO = Cast<UModularGameplayAbility>(Spec->Ability);
+		const FGameplayTagContainer* CooldownTags = ModularCDO ? ModularCDO->GetCooldownTagsForLevel(Spec->Level) : Spec->Ability->GetCooldownTags();
+		if (CooldownTags)
+		{
+			Entry->CooldownTags = *CooldownTags;
+			CooldownCacheTags.AppendTags(*CooldownTags);
+		}
+		else
+		{
+			Entry->CooldownTags.Reset();
+		}
+	}
+
+	if (OutDuration)
+	{
+		*OutDuration = Entry->Duration;
+	}
+
+	return FMath::Max(static_cast<float>(Entry->StartTime + Entry->Duration - Now), 0.f);
+}
+
+void UModularAbilitySystemComponent::RecordAbilityCooldown(const FGameplayAbilitySpecHandle& Handle, float Duration, const FGameplayTagContainer& CooldownTags)
+{
+	// The cooldown may be shared with other specs through its tags, so those need to be re-evaluated
+	InvalidateCooldownCache(CooldownTags.GetGameplayTagArray());
+
+	if (!FindAbilitySpecFromHandleCached(Handle))
+	{
+		return;
+	}
+
+	const UWorld* World = GetWorld();
+
+	FModularAbilityCooldownCacheEntry& Entry = CooldownCache.FindOrAdd(Handle);
+	Entry.StartTime = World ? World->GetTimeSeconds() : 0.0;
+	Entry.Duration = Duration;
+	Entry.CooldownTags = CooldownTags;
+	Entry.bOutdated = false;
+
+	CooldownCacheTags.AppendTags(CooldownTags);
+}
+
+void UModularAbilitySystemComponent::InvalidateCooldownCache(TConstArrayView<FGameplayTag> ChangedTags)
+{
+	for (TPair<FGameplayAbilitySpecHandle, FModularAbilityCooldownCacheEntry>& Pair : CooldownCache)
+	{
+		FModularAbilityCooldownCacheEntry& Entry = Pair.Value;
+		if (Entry.bOutdated)
+		{
+			continue;
+		}
+
+		for (const FGameplayTag& ChangedTag : ChangedTags)
+		{
+			if (Entry.CooldownTags.HasTag(ChangedTag))
+			{
+				Entry.bOutdated = true;
+				break;
+			}
+		}
+	}
+}
+
+void UModularAbilitySystemComponent::InvalidateCooldownCache(const FGameplayAbilitySpecHandle& Handle)
+{
+	if (FModularAbilityCooldownCacheEntry* Entry = CooldownCache.Find(Handle))
+	{
+		Entry->bOutdated = true;
+	}
+}
+
+void UModularAbilitySystemComponent::OnCooldownEffectRemoved(const FActiveGameplayEffect& Effect)
+{
+	// Only effects granting cached cooldown tags matter. Removing one doesn't always change the owned tags, e.g. if another effect grants the same tag
+	if (!Effect.Spec.DynamicGrantedTags.HasAny(CooldownCacheTags) && !(Effect.Spec.Def && Effect.Spec.Def->GetGrantedTags().HasAny(CooldownCacheTags)))
+	{
+		return;
+	}
+
+	InvalidateCooldownCache(Effect.Spec.DynamicGrantedTags.GetGameplayTagArray());
+	if (Effect.Spec.Def)
+	{
+		InvalidateCooldownCache(Effect.Spec.Def->GetGrantedTags().GetGameplayTagArray());
+	}
+}
+
+const FModularAbilityChargeEntry* UModularAbilitySystemComponent::FindAbilityCharges(const FGameplayAbilitySpecHandle& Handle) const
+{
+	// Predicted charges are always newer than the replicated ones, as they are dropped once the server caught up with them
+	if (const FModularAbilityChargeEntry* PredictedEntry = PredictedAbilityCharges.Find(Handle))
+	{
+		return PredictedEntry;
+	}
+
+	return AbilityCharges.Find(Handle);
+}
+
+int32 UModularAbilitySystemComponent::GetAbilityCharges(const FGameplayAbilitySpecHandle& Handle, int32 MaxCharges) const
+{
+	const FModularAbilityChargeEntry* Entry = FindAbilityCharges(Handle);
+	return Entry ? FMath::Min(Entry->GetCharges(GetCooldownLedgerTime()), MaxCharges) : MaxCharges;
+}
+
+void UModularAbilitySystemComponent::ConsumeAbilityCharge(
+	const FGameplayAbilitySpecHandle& Handle, int32 MaxCharges, float RechargeDuration, FPredictionKey PredictionKey)
+{
+	if (MaxCharges <= 0 || RechargeDuration <= 0.f)
+	{
+		return;
+	}
+
+	const FModularAbilityChargeEntry* ExistingEntry = FindAbilityCharges(Handle);
+
+	FModularAbilityChargeEntry NewEntry(Handle, MaxCharges, RechargeDuration);
+	if (ExistingEntry)
+	{
+		NewEntry.FullyChargedTime = ExistingEntry->FullyChargedTime;
+	}
+
+	NewEntry.ConsumeCharge(GetCooldownLedgerTime());
+	InvalidateCooldownCache(Handle);
+
+	if (IsOwnerActorAuthoritative())
+	{
+		AbilityCharges.Set(NewEntry);
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, AbilityCharges, this);
+	}
+	else
+	{
+		PredictedAbilityCharges.Add(Handle, NewEntry);
+
+		if (PredictionKey.IsValidForMorePrediction())
+		{
+			PredictionKey.NewRejectedDelegate().BindUObject(this, &ThisClass::OnPredictedAbilityChargeRejected, Handle);
+		}
+	}
+
+	MarkActivatableAbilitiesDirty();
+	ScheduleCooldownExpiry();
+}
+
+void UModularAbilitySystemComponent::OnPredictedAbilityChargeRejected(FGameplayAbilitySpecHandle Handle)
+{
+	PredictedAbilityCharges.Remove(Handle);
+	InvalidateCooldownCache(Handle);
+
+	MarkActivatableAbilitiesDirty();
+	ScheduleCooldownExpiry();
+}
+
+void UModularAbilitySystemComponent::OnAbilityChargesReplicated(const FModularAbilityChargeEntry& Entry)
+{
+	// Only drop the prediction once the server caught up with every predicted charge, another predicted consume may still be in flight
+	if (const FModularAbilityChargeEntry* PredictedEntry = PredictedAbilityCharges.Find(Entry.Handle))
+	{
+		if (Entry.HasCaughtUpWith(*PredictedEntry))
+		{
+			PredictedAbilityCharges.Remove(Entry.Handle);
+		}
+	}
+
+	InvalidateCooldownCache(Entry.Handle);
+
+	MarkActivatableAbilitiesDirty();
+	ScheduleCooldownExpiry();
+}
+
+void UModularAbilitySystemComponent::OnRep_ActivateAbilities()
+{
+	Super::OnRep_ActivateAbilities();
+
+	InvalidateAbilitySpecIndices();
+	MarkActivatableAbilitiesDirty();
+
+	// Dynamic spec tags may have changed on the server without the spec being re-added
+	RebuildAbilityInputBindings();
+	RebuildRequiredTagWatchers();
+	RebuildCooldownGroups();
+}
+
+void UModularAbilitySystemComponent::AddAbilitySpecToRequiredTagWatchers(const FGameplayAbilitySpec& Spec)
+{
+	const UModularGameplayAbility* AbilityCDO = Cast<UModularGameplayAbility>(Spec.Ability);
+	if (!AbilityCDO || Spec.PendingRemove)
+	{
+		return;
+	}
+
+	// Same tags the spawn activation requires, so both paths agree on when a passive ability is ready
+	const FGameplayTagContainer& RequiredTags = AbilityCDO->GetPassiveActivationWatchedTags();
+	if (RequiredTags.IsEmpty())
+	{
+		return;
+	}
+
+	for (const FGameplayTag& RequiredTag : RequiredTags)
+	{
+		RequiredTagWatchers.FindOrAdd(RequiredTag).AddUnique(Spec.Handle);
+	}
+
+	SpecRequiredTagKeys.Add(Spec.Handle, RequiredTags);
+}
+
+void UModularAbilitySystemComponent::RemoveAbilitySpecFromRequiredTagWatchers(const FGameplayAbilitySpecHandle& Handle)
+{
+	FGameplayTagContainer RequiredTags;
+	if (!SpecRequiredTagKeys.RemoveAndCopyValue(Handle, RequiredTags))
+	{
+		return;
+	}
+
+	for (const FGameplayTag& RequiredTag : RequiredTags)
+	{
+		TArray<FGameplayAbilitySpecHandle, TInlineAllocator<2>>* Watchers = RequiredTagWatchers.Find(RequiredTag);
+		if (Watchers == nullptr)
+		{
+			continue;
+		}
+
+		Watchers->RemoveSingleSwap(Handle);
+
+		if (Watchers->IsEmpty())
+		{
+			RequiredTagWatchers.Remove(RequiredTag);
+		}
+	}
+}
+
+void UModularAbilitySystemComponent::RebuildRequiredTagWatchers()
+{
+	RequiredTagWatchers.Reset();
+	SpecRequiredTagKeys.Reset();
+
+	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	{
+		AddAbilitySpecToRequiredTagWatchers(Spec);
+	}
+}
+
+void UModularAbilitySystemComponent::TryActivateAbilitiesWaitingForTag(const FGameplayTag& Tag)
+{
+	// Required tags are matched exactly, same as on spawn, so only the added tag itself needs to be looked up
+	const TArray<FGameplayAbilitySpecHandle, TInlineAllocator<2>>* Watchers = RequiredTagWatchers.Find(Tag);
+	if (Watchers == nullptr)
+	{
+		return;
+	}
+
+	const TArray<FGameplayAbilitySpecHandle, TInlineAllocator<4>> HandlesToEvaluate(*Watchers);
+
+	// Activating an ability may add further tags or grant abilities, so only the collected handles are iterated
+	for (const FGameplayAbilitySpecHandle& Handle : HandlesToEvaluate)
+	{
+		const FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleCached(Handle);
+		if (!Spec || Spec->IsActive())
+		{
+			continue;
+		}
+
+		const UModularGameplayAbility* AbilityCDO = Cast<UModularGameplayAbility>(Spec->Ability);
+		if (AbilityCDO && AbilityCDO->HasPassiveActivationRequiredTags(*this))
+		{
+			AbilityCDO->TryActivatePassiveAbility(AbilityActorInfo.Get(), *Spec);
+		}
+	}
+}
+
+void UModularAbilitySystemComponent::RefreshAbilitySpecInputBinding(const FGameplayAbilitySpec& Spec)
+{
+	RemoveAbilitySpecFromInputBindings(Spec.Handle);
+	AddAbilitySpecToInputBindings(Spec);
+}
+
+void UModularAbilitySystemComponent::AddAbilitySpecToInputBindings(const FGameplayAbilitySpec& Spec)
+{
+	if (!Spec.Ability || Spec.PendingRemove)
+	{
+		return;
+	}
+
+	const int32 Slot = GetAbilitySpecSlot(Spec.Handle);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	const bool bReceivesInput = ModularAbilitySystem::DoesSpecReceiveInput(Spec);
+	FModularAbilitySpecInputKeys InputKeys;
+
+	if (bUseAlterAbilityInput)
+	{
+		if (Spec.InputID < 0)
+		{
+			return;
+		}
+
+		if (!InputIdBindings.IsValidIndex(Spec.InputID))
+		{
+			InputIdBindings.SetNum(Spec.InputID + 1);
+		}
+
+		InputIdBindings[Spec.InputID].Emplace(Spec.Handle, Slot, bReceivesInput);
+		InputKeys.InputID = Spec.InputID;
+	}
+	else
+	{
+		const FGameplayTagContainer& InputTags = ModularAbilitySystem::GetSpecInputTags(Spec);
+		if (InputTags.IsEmpty())
+		{
+			return;
+		}
+
+		for (const FGameplayTag& InputTag : InputTags)
+		{
+			InputTagBindings.FindOrAdd(InputTag).Emplace(Spec.Handle, Slot, bReceivesInput);
+		}
+
+		InputKeys.InputTags = InputTags;
+	}
+
+	SpecInputKeys.Add(Spec.Handle, MoveTemp(InputKeys));
+}
+
+void UModularAbilitySystemComponent::RemoveAbilitySpecFromInputBindings(const FGameplayAbilitySpecHandle& Handle)
+{
+	FModularAbilitySpecInputKeys InputKeys;
+	if (!SpecInputKeys.RemoveAndCopyValue(Handle, InputKeys))
+	{
+		return;
+	}
+
+	auto MatchesHandle = [&Handle](const FModularAbilityInputBinding& Binding)
+	{
+		return Binding.Handle == Handle;
+	};
+
+	if (InputIdBindings.IsValidIndex(InputKeys.InputID))
+	{
+		InputIdBindings[InputKeys.InputID].RemoveAllSwap(MatchesHandle);
+	}
+
+	for (const FGameplayTag& InputTag : InputKeys.InputTags)
+	{
+		TArray<FModularAbilityInputBinding>* Bindings = InputTagBindings.Find(InputTag);
+		if (Bindings == nullptr)
+		{
+			continue;
+		}
+
+		Bindings->RemoveAllSwap(MatchesHandle);
+
+		if (Bindings->IsEmpty())
+		{
+			InputTagBindings.Remove(InputTag);
+		}
+	}
+}
+
+void UModularAbilitySystemComponent::RebuildAbilityInputBindings()
+{
+	InputTagBindings.Reset();
+	InputIdBindings.Reset();
+	SpecInputKeys.Reset();
+
+	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	{
+		AddAbilitySpecToInputBindings(Spec);
+	}
+}
+
+FGameplayAbilitySpec* UModularAbilitySystemComponent::FindAbilitySpecFromHandleCached(const FGameplayAbilitySpecHandle& Handle) const
+{
+	if (bAbilitySpecIndicesDirty)
+	{
+		RebuildAbilitySpecIndices();
+	}
+
+	auto FindSpec = [this, &Handle]() -> FGameplayAbilitySpec*
+	{
+		const int32* Index = AbilitySpecIndices.Find(Handle);
+		if (Index && ActivatableAbilities.Items.IsValidIndex(*Index) && (ActivatableAbilities.Items[*Index].Handle == Handle))
+		{
+			return const_cast<FGameplayAbilitySpec*>(&ActivatableAbilities.Items[*Index]);
+		}
+
+		return nullptr;
+	};
+
+	if (FGameplayAbilitySpec* Spec = FindSpec())
+	{
+		return Spec;
+	}
+
+	// The array may have been mutated without us being notified (e.g., a removal swapped another spec into place).
+	// Only rebuild if the handle was known, unknown handles simply don't exist.
+	if (AbilitySpecIndices.Contains(Handle))
+	{
+		RebuildAbilitySpecIndices();
+		return FindSpec();
+	}
+
+	return nullptr;
+}
+
+void UModularAbilitySystemComponent::RebuildAbilitySpecIndices() const
+{
+	AbilitySpecIndices.Reset();
+
+	for (int32 Idx = 0; Idx < ActivatableAbilities.Items.Num(); ++Idx)
+	{
+		AbilitySpecIndices.Add(ActivatableAbilities.Items[Idx].Handle, Idx);
+	}
+
+	bAbilitySpecIndicesDirty = false;
+}
+
+int32 UModularAbilitySystemComponent::AllocateAbilitySpecSlot(const FGameplayAbilitySpecHandle& Handle)
+{
+	if (const int32* ExistingSlot = AbilitySpecSlots.Find(Handle))
+	{
+		return *ExistingSlot;
+	}
+
+	int32 Slot;
+	if (FreeAbilitySpecSlots.Num() > 0)
+	{
+		Slot = FreeAbilitySpecSlots.Pop();
+		AbilitySpecSlotHandles[Slot] = Handle;
+	}
+	else
+	{
+		Slot = AbilitySpecSlotHandles.Add(Handle);
+		InputPressedSlots.Add(false);
+		InputReleasedSlots.Add(false);
+		InputHeldSlots.Add(false);
+	}
+
+	AbilitySpecSlots.Add(Handle, Slot);
+	return Slot;
+}
+
+void UModularAbilitySystemComponent::ReleaseAbilitySpecSlot(const FGameplayAbilitySpecHandle& Handle)
+{
+	int32 Slot = INDEX_NONE;
+	if (!AbilitySpecSlots.RemoveAndCopyValue(Handle, Slot))
+	{
+		return;
+	}
+
+	// Make sure pending input doesn't leak into the next spec using this slot
+	InputPressedSlots[Slot] = false;
+	InputReleasedSlots[Slot] = false;
+	InputHeldSlots[Slot] = false;
+
+	AbilitySpecSlotHandles[Slot] = FGameplayAbilitySpecHandle();
+	FreeAbilitySpecSlots.Add(Slot);
+}
+
+void UModularAbilitySystemComponent::TryActivateAbilitiesOnSpawn()
+{
+	ABILITYLIST_SCOPE_LOCK();
+
+	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	{
+		const UModularGameplayAbility* AbilityCDO = Cast<UModularGameplayAbility>(Spec.Ability);
+		if (!AbilityCDO)
+		{
+			continue;
+		}
+
+		bool bAnyInstancesFound = false;
+PRAGMA_DISABLE_DEPRECATION_WARNINGS
+		if (AbilityCDO->GetInstancingPolicy() != EGameplayAbilityInstancingPolicy::NonInstanced)
+		{
+			TArray<UGameplayAbility*> Instances = Spec.GetAbilityInstances();
+			for (UGameplayAbility* Instance : Instances)
 			{
-				continue;
+				if (const UModularGameplayAbility* ModularInstance = Cast<UModularGameplayAbility>(Instance))
+				{
+					ModularInstance->TryActivateAbilityOnSpawn(AbilityActorInfo.Get(), Spec);
+				}
 			}
 
-			InputPressedHandles.AddUnique(Spec.Handle);
-			InputHeldHandles.AddUnique(Spec.Handle);
+			bAnyInstancesFound = Instances.Num() > 0;
+		}
+
+		if (!bAnyInstancesFound)
+		{
+			AbilityCDO->TryActivateAbilityOnSpawn(AbilityActorInfo.Get(), Spec);
 		}
+PRAGMA_ENABLE_DEPRECATION_WARNINGS
 	}
 }
 
-void UModularAbilitySystemComponent::AbilityInputTagReleased(const FGameplayTag& InputTag)
+void UModularAbilitySystemComponent::GetAbilityTargetData(
+	const FGameplayAbilitySpecHandle AbilityHandle,
+	const FGameplayAbilityActivationInfo& ActivationInfo,
+	FGameplayAbilityTargetDataHandle& OutTargetDataHandle)
+{
+	TSharedPtr<FAbilityReplicatedDataCache> ReplicatedDataCache =
+		AbilityTargetDataMap.Find(FGameplayAbilitySpecHandleAndPredictionKey(AbilityHandle, ActivationInfo.GetActivationPredictionKey()));
+
+	if (ReplicatedDataCache.IsValid())
+	{
+		OutTargetDataHandle = ReplicatedDataCache->TargetData;
+	}
+}
+
+void UModularAbilitySystemComponent::CancelAbilitiesByFunc(
+	TShouldCancelAbilityFunc ShouldCancelFunc, bool bReplicateCancelAbility)
+{
+	ABILITYLIST_SCOPE_LOCK();
+
+	for (const auto& Spec : ActivatableAbilities.Items)
+	{
+		if (!Spec.IsActive())
+		{
+			continue;
+		}
+
+		UModularGameplayAbility* AbilityCDO = Cast<UModularGameplayAbility>(Spec.Ability);
+		if (!AbilityCDO)
+		{
+			continue;
+		}
+PRAGMA_DISABLE_DEPRECATION_WARNINGS
+		if (AbilityCDO->GetInstancingPolicy() != EGameplayAbilityInstancingPolicy::NonInstanced)
+		{
+			// Cancel all instances of the ability
+			TArray<UGameplayAbility*> Instances = Spec.GetAbilityInstances();
+			for (UGameplayAbility* Instance : Instances)
+			{
+				UModularGameplayAbility* ModularAbility = CastChecked<UModularGameplayAbility>(Instance);
+
+				if (ShouldCancelFunc(ModularAbility, Spec.Handle))
+				{
+					if (ModularAbility->CanBeCanceled())
+					{
+						ModularAbility->CancelAbility(Spec.Handle, AbilityActorInfo.Get(), ModularAbility->GetCurrentActivationInfo(), bReplicateCancelAbility);
+					}
+					else
+					{
+						ABILITY_LOG(Error, TEXT("%hs: Can't cancel ability [%s] because CanBeCanceled() is false."), __func__, *ModularAbility->GetName());
+					}
+				}
+			}
+		}
+		else
+		{
+			// Cancel CDO
+			if (ShouldCancelFunc(AbilityCDO, Spec.Handle))
+			{
+				// CDO can always be canceled
+				check(AbilityCDO->CanBeCanceled());
+				AbilityCDO->CancelAbility(Spec.Handle, AbilityActorInfo.Get(), FGameplayAbilityActivationInfo(), bReplicateCancelAbility);
+			}
+		}
+PRAGMA_ENABLE_DEPRECATION_WARNINGS
+	}
+}
+
+void UModularAbilitySystemComponent::CancelInputActivatedAbilities(bool bReplicateCancelAbility)
+{
+	auto ShouldCancelFunc = [this](const UModularGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle)
+	{
+		const EGameplayAbilityActivationPolicy::Type ActivationPolicy = Ability->GetActivationPolicy();
+		return (ActivationPolicy == EGameplayAbilityActivationPolicy::Active) || Ability->IsForceReceiveInput();
+	};
+
+	CancelAbilitiesByFunc(ShouldCancelFunc, bReplicateCancelAbility);
+}
+
+void UModularAbilitySystemComponent::AbilityInputTagPressed(const FGameplayTag& InputTag)
 {
-	if (UModularGameplayAbilitiesSettings::IsUsingAlterAbilityInput())
+	if (bUseAlterAbilityInput)
 	{
 		checkf(false, TEXT("UModularGameplayAbilitiesSettings::IsUsingExperimentalInput() is enabled. Please use the new input system instead of the old one."));
 	}
@@ -736,84 +2093,118 @@ void UModularAbilitySystemComponent::AbilityInputTagReleased(const FGameplayTag&
 		return;
 	}
 
-	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	const TArray<FModularAbilityInputBinding>* Bindings = InputTagBindings.Find(InputTag);
+	if (Bindings == nullptr)
 	{
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 5
-		if (Spec.Ability && Spec.GetDynamicSpecSourceTags().HasTagExact(InputTag))
-#else
-		if (Spec.Ability && Spec.DynamicAbilityTags.HasTagExact(InputTag))
-#endif
+		return;
+	}
+
+	for (const FModularAbilityInputBinding& Binding : *Bindings)
+	{
+		if (!Binding.bReceivesInput)
+		{
+			continue;
+		}
+
+		// If the ability is already held, don't add it again
+		// Otherwise the ability will keep activating
+		if (InputHeldSlots[Binding.Slot])
 		{
-			InputHeldHandles.Remove(Spec.Handle);
-			InputReleasedHandles.AddUnique(Spec.Handle);
+			continue;
 		}
+
+		InputPressedSlots[Binding.Slot] = true;
+		InputHeldSlots[Binding.Slot] = true;
+	}
+}
+
+void UModularAbilitySystemComponent::AbilityInputTagReleased(const FGameplayTag& InputTag)
+{
+	if (bUseAlterAbilityInput)
+	{
+		checkf(false, TEXT("UModularGameplayAbilitiesSettings::IsUsingExperimentalInput() is enabled. Please use the new input system instead of the old one."));
+	}
+
+	if (!InputTag.IsValid())
+	{
+		return;
+	}
+
+	const TArray<FModularAbilityInputBinding>* Bindings = InputTagBindings.Find(InputTag);
+	if (Bindings == nullptr)
+	{
+		return;
+	}
+
+	for (const FModularAbilityInputBinding& Binding : *Bindings)
+	{
+		InputHeldSlots[Binding.Slot] = false;
+		InputReleasedSlots[Binding.Slot] = true;
 	}
 }
 
 void UModularAbilitySystemComponent::AbilityInputIdPressed(int32 InputId)
 {
-	if (UModularGameplayAbilitiesSettings::IsNotUsingAlterAbilityInput())
+	if (!bUseAlterAbilityInput)
 	{
 		checkf(false, TEXT("UModularGameplayAbilitiesSettings::IsUsingExperimentalInput() is disabled. Please use the old input system instead of the new one."));
 	}
 
-	if (InputId == INDEX_NONE)
+	if (!InputIdBindings.IsValidIndex(InputId))
 	{
 		return;
 	}
 
-	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	for (const FModularAbilityInputBinding& Binding : InputIdBindings[InputId])
 	{
-		if (Spec.Ability && Spec.InputID == InputId)
+		if (!Binding.bReceivesInput)
 		{
-			UModularGameplayAbility* CDO = Cast<UModularGameplayAbility>(Spec.Ability);
-			if (CDO == nullptr)
-			{
-				continue;
-			}
-
-			if ((CDO->GetActivationPolicy() != EGameplayAbilityActivationPolicy::Active) &&
-				!CDO->IsForceReceiveInput())
-			{
-				continue;
-			}
-
-			// If the ability is already held, don't add it again
-			// Otherwise the ability will keep activating
-			if (InputHeldHandles.Contains(Spec.Handle))
-			{
-				continue;
-			}
+			continue;
+		}
 
-			InputPressedHandles.AddUnique(Spec.Handle);
-			InputHeldHandles.AddUnique(Spec.Handle);
+		// If the ability is already held, don't add it again
+		// Otherwise the ability will keep activating
+		if (InputHeldSlots[Binding.Slot])
+		{
+			continue;
 		}
+
+		InputPressedSlots[Binding.Slot] = true;
+		InputHeldSlots[Binding.Slot] = true;
 	}
 }
 
 void UModularAbilitySystemComponent::AbilityInputIdReleased(int32 InputId)
 {
-	if (UModularGameplayAbilitiesSettings::IsNotUsingAlterAbilityInput())
+	if (!bUseAlterAbilityInput)
 	{
 		checkf(false, TEXT("UModularGameplayAbilitiesSettings::IsUsingExperimentalInput() is disabled. Please use the old input system instead of the new one."));
 	}
 
-	if (InputId == INDEX_NONE)
+	if (!InputIdBindings.IsValidIndex(InputId))
 	{
 		return;
 	}
 
-	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	for (const FModularAbilityInputBinding& Binding : InputIdBindings[InputId])
 	{
-		if (Spec.Ability && Spec.InputID == InputId)
-		{
-			InputHeldHandles.Remove(Spec.Handle);
-			InputReleasedHandles.AddUnique(Spec.Handle);
-		}
+		InputHeldSlots[Binding.Slot] = false;
+		InputReleasedSlots[Binding.Slot] = true;
 	}
 }
 
 void UModularAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGamePaused)
+{
+	// The ability subsystem processes the input of all ability systems in one pass
+	if (bAbilityInputBatched)
+	{
+		return;
+	}
+
+	ProcessAbilityInputInternal(DeltaTime, bGamePaused);
+}
+
+void UModularAbilitySystemComponent::ProcessAbilityInputInternal(float DeltaTime, bool bGamePaused)
 {
 	if (bGamePaused)
 	{
@@ -827,13 +2218,16 @@ void UModularAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool b
 		return;
 	}
 
-	static TArray<FGameplayAbilitySpecHandle> HandlesToActivate;
+	// Defer any abilities given or removed while processing, so the slots stay valid while we iterate them
+	ABILITYLIST_SCOPE_LOCK();
+
 	HandlesToActivate.Reset();
 
 	// Process input for abilities that are held
-	for (const auto& Handle : InputHeldHandles)
+	for (TConstSetBitIterator<> It(InputHeldSlots); It; ++It)
 	{
-		if (const FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandle(Handle))
+		const FGameplayAbilitySpecHandle Handle = AbilitySpecSlotHandles[It.GetIndex()];
+		if (const FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleCached(Handle))
 		{
 			if (!Spec->Ability | Spec->IsActive())
 			{
@@ -849,9 +2243,10 @@ void UModularAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool b
 	}
 
 	// Process input for abilities that are pressed
-	for (const auto& Handle : InputPressedHandles)
+	for (TConstSetBitIterator<> It(InputPressedSlots); It; ++It)
 	{
-		if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandle(Handle))
+		const FGameplayAbilitySpecHandle Handle = AbilitySpecSlotHandles[It.GetIndex()];
+		if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleCached(Handle))
 		{
 			if (!Spec->Ability)
 			{
@@ -887,7 +2282,7 @@ void UModularAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool b
 		// we also need to call AbilitySpecInputPressed again, as it wasnt above
 		if (bDidActivate)
 		{
-			FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandle(Handle);
+			FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleCached(Handle);
 			check(Spec)
 
 			if (Spec->InputPressed)
@@ -895,14 +2290,24 @@ void UModularAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool b
 				AbilitySpecInputPressed(*Spec);
 			}
 		}
+		else
+		{
+			// Only buffer fresh presses, held input is retried every frame anyway
+			const int32 Slot = GetAbilitySpecSlot(Handle);
+			if (InputPressedSlots.IsValidIndex(Slot) && InputPressedSlots[Slot])
+			{
+				BufferAbilityInput(Handle);
+			}
+		}
 
 		ABILITY_LOG(VeryVerbose, TEXT("TryActivateAbility %s: %s"), *Handle.ToString(), bDidActivate ? TEXT("Success") : TEXT("Failed"));
 	}
 
 	// Process input for abilities that are released
-	for (const auto& Handle : InputReleasedHandles)
+	for (TConstSetBitIterator<> It(InputReleasedSlots); It; ++It)
 	{
-		if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandle(Handle))
+		const FGameplayAbilitySpecHandle Handle = AbilitySpecSlotHandles[It.GetIndex()];
+		if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleCached(Handle))
 		{
 			if (!Spec->Ability)
 			{
@@ -919,15 +2324,130 @@ void UModularAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool b
 		}
 	}
 
-	InputPressedHandles.Reset();
-	InputReleasedHandles.Reset();
+	InputPressedSlots.SetRange(0, InputPressedSlots.Num(), false);
+	InputReleasedSlots.SetRange(0, InputReleasedSlots.Num(), false);
+
+	// Send all input events generated this frame in one go
+	FlushReplicatedInputEvents();
+}
+
+UModularAbilityInputRouter* UModularAbilitySystemComponent::GetInputRouter()
+{
+	if (!InputRouter)
+	{
+		InputRouter = NewObject<UModularAbilityInputRouter>(this, NAME_None, RF_Transient);
+	}
+
+	return InputRouter;
+}
+
+bool UModularAbilitySystemComponent::HasPendingAbilityInput() const
+{
+	return InputPressedSlots.Contains(true) || InputHeldSlots.Contains(true) || InputReleasedSlots.Contains(true);
 }
 
 void UModularAbilitySystemComponent::ClearAbilityInput()
 {
-	InputPressedHandles.Reset();
-	InputHeldHandles.Reset();
-	InputReleasedHandles.Reset();
+	InputPressedSlots.SetRange(0, InputPressedSlots.Num(), false);
+	InputHeldSlots.SetRange(0, InputHeldSlots.Num(), false);
+	InputReleasedSlots.SetRange(0, InputReleasedSlots.Num(), false);
+
+	BufferedAbilityInputs.Reset();
+}
+
+void UModularAbilitySystemComponent::BufferAbilityInput(const FGameplayAbilitySpecHandle& Handle)
+{
+	// Read on use, so changing the setting in the editor applies to running sessions
+	const float AbilityInputBufferWindow = UModularGameplayAbilitiesSettings::GetAbilityInputBufferWindow();
+
+	const UWorld* World = GetWorld();
+	if (AbilityInputBufferWindow <= 0.f || !World)
+	{
+		return;
+	}
+
+	const double Now = World->GetTimeSeconds();
+
+	// Drop expired presses, as they are only pruned when retried
+	BufferedAbilityInputs.RemoveAll([AbilityInputBufferWindow, Now](const FModularBufferedAbilityInput& Entry)
+	{
+		return (Now - Entry.PressTime) > AbilityInputBufferWindow;
+	});
+
+	// A repeated press refreshes the timestamp of the existing entry
+	BufferedAbilityInputs.RemoveAll([&Handle](const FModularBufferedAbilityInput& Entry)
+	{
+		return Entry.Handle == Handle;
+	});
+
+	BufferedAbilityInputs.Emplace(Handle, Now);
+}
+
+void UModularAbilitySystemComponent::ScheduleBufferedAbilityInputRetry()
+{
+	UWorld* World = GetWorld();
+	if (bBufferedAbilityInputRetryPending || !World)
+	{
+		return;
+	}
+
+	// Retry on the next tick, so the ended ability has finished cleaning up and we don't activate from within EndAbility
+	bBufferedAbilityInputRetryPending = true;
+	World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &ThisClass::RetryBufferedAbilityInput));
+}
+
+void UModularAbilitySystemComponent::RetryBufferedAbilityInput()
+{
+	bBufferedAbilityInputRetryPending = false;
+
+	const UWorld* World = GetWorld();
+	if (BufferedAbilityInputs.IsEmpty() || !World)
+	{
+		return;
+	}
+
+	if (World->IsPaused() || !IsAbilityInputAllowed())
+	{
+		BufferedAbilityInputs.Reset();
+		return;
+	}
+
+	ABILITYLIST_SCOPE_LOCK();
+
+	const double Now = World->GetTimeSeconds();
+	const float AbilityInputBufferWindow = UModularGameplayAbilitiesSettings::GetAbilityInputBufferWindow();
+
+	for (int32 Idx = 0; Idx < BufferedAbilityInputs.Num();)
+	{
+		const FGameplayAbilitySpecHandle Handle = BufferedAbilityInputs[Idx].Handle;
+
+		// Drop presses that expired, or whose ability got removed or activated in the meantime
+		const FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleCached(Handle);
+		if (!Spec || !Spec->Ability || Spec->IsActive() || (Now - BufferedAbilityInputs[Idx].PressTime) > AbilityInputBufferWindow)
+		{
+			BufferedAbilityInputs.RemoveAt(Idx);
+			continue;
+		}
+
+		if (!TryActivateAbility(Handle))
+		{
+			// Still blocked, keep it around until the next ability ends or it expires
+			++Idx;
+			continue;
+		}
+
+		ABILITY_LOG(VeryVerbose, TEXT("%hs: Activated buffered input %s"), __func__, *Handle.ToString());
+
+		BufferedAbilityInputs.RemoveAt(Idx);
+
+		if (FGameplayAbilitySpec* ActivatedSpec = FindAbilitySpecFromHandleCached(Handle))
+		{
+			if (ActivatedSpec->InputPressed)
+			{
+				AbilitySpecInputPressed(*ActivatedSpec);
+			}
+		}
+	}
 }
 
 void UModularAbilitySystemComponent::DeferredSetBaseAttributeValueFromReplication(
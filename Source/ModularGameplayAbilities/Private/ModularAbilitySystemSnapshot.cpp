@@ -0,0 +1,35 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+
+#include "ModularAbilitySystemSnapshot.h"
+
+const FModularAbilitySpecSnapshot* FModularAbilitySystemSnapshot::FindSpec(const FGameplayAbilitySpecHandle& Handle) const
+{
+	return Specs.FindByPredicate([&Handle](const FModularAbilitySpecSnapshot& Spec)
+	{
+		return Spec.Handle == Handle;
+	});
+}
+
+const FModularAbilitySpecSnapshot* FModularAbilitySystemSnapshot::FindSpecByClass(const UClass* AbilityClass) const
+{
+	const TObjectKey<UClass> ClassKey(AbilityClass);
+	return Specs.FindByPredicate([&ClassKey](const FModularAbilitySpecSnapshot& Spec)
+	{
+		return Spec.AbilityClass == ClassKey;
+	});
+}
+
+bool FModularAbilitySystemSnapshot::GetAttributeValue(const FGameplayAttribute& Attribute, float& OutValue) const
+{
+	for (const TPair<FGameplayAttribute, float>& AttributeValue : AttributeValues)
+	{
+		if (AttributeValue.Key == Attribute)
+		{
+			OutValue = AttributeValue.Value;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -3,73 +3,619 @@
 
 #include "ModularAbilityTagRelationshipMapping.h"
 
+#include "AbilitySystemLog.h"
+#include "UObject/ObjectSaveContext.h"
+#include "UObject/Package.h"
+
+#include <atomic>
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ModularAbilityTagRelationshipMapping)
 
-UModularAbilityTagRelationshipMapping::UModularAbilityTagRelationshipMapping()
+namespace ModularTagRelationship
 {
+	/** Serial handed out to the next compiled mapping. Shared between all mappings, so switching mappings changes the serial as well. */
+	static std::atomic<uint32> NextCompileSerial = 0;
+
+	/** Number of output bitsets of each relationship. */
+	static constexpr int32 NumOutputs = 4;
+
+	static void SetBit(TArrayView<uint64> Words, int32 Index)
+	{
+		Words[Index >> 6] |= (uint64(1) << (Index & 63));
+	}
+
+	static bool TestBit(TConstArrayView<uint64> Words, int32 Index)
+	{
+		return (Words[Index >> 6] & (uint64(1) << (Index & 63))) != 0;
+	}
+
+	/** Returns the output containers of the relationship, in the order of FModularAbilityTagRelationshipResult. */
+	static void GetOutputs(const FModularAbilityTagRelationship& Relationship, const FGameplayTagContainer* (&OutOutputs)[NumOutputs])
+	{
+		OutOutputs[0] = &Relationship.AbilityTagsToBlock;
+		OutOutputs[1] = &Relationship.AbilityTagsToCancel;
+		OutOutputs[2] = &Relationship.ActivationRequiredTags;
+		OutOutputs[3] = &Relationship.ActivationBlockedTags;
+	}
+
+	/** Returns the output containers of the result, in the order of FModularAbilityTagRelationshipResult. */
+	static void GetOutputs(FModularAbilityTagRelationshipResult& Result, FGameplayTagContainer* (&OutOutputs)[NumOutputs])
+	{
+		OutOutputs[0] = &Result.TagsToBlock;
+		OutOutputs[1] = &Result.TagsToCancel;
+		OutOutputs[2] = &Result.ActivationRequiredTags;
+		OutOutputs[3] = &Result.ActivationBlockedTags;
+	}
 }
 
-void UModularAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(
+//////////////////////////////////////////////////////////////////////////
+/// FModularCompiledTagRelationshipTable
+
+FModularCompiledTagRelationshipEntry::FModularCompiledTagRelationshipEntry()
+{
+	FMemory::Memzero(ExactOutputs);
+	FMemory::Memzero(PartialOutputs);
+}
+
+void FModularCompiledTagRelationshipTable::Build(TConstArrayView<FModularAbilityTagRelationship> Relationships)
+{
+	using namespace ModularTagRelationship;
+
+	ContainerPool.Reset();
+	Entries.Reset();
+
+	// The empty container is shared by all unused outputs
+	ContainerPool.AddDefaulted();
+
+	// Merge the relationships of each ability tag, separately for exact and partial matches
+	struct FMergedOutputs
+	{
+		FGameplayTagContainer Exact[NumOutputs];
+		FGameplayTagContainer Partial[NumOutputs];
+		FGameplayTagContainer ActionCancel;
+	};
+
+	TMap<FGameplayTag, FMergedOutputs> MergedByTag;
+	for (const FModularAbilityTagRelationship& Relationship : Relationships)
+	{
+		if (!Relationship.AbilityTag.IsValid())
+		{
+			continue;
+		}
+
+		FMergedOutputs& Merged = MergedByTag.FindOrAdd(Relationship.AbilityTag);
+		FGameplayTagContainer* MergedOutputs = Relationship.bMatchPartialTag ? Merged.Partial : Merged.Exact;
+
+		const FGameplayTagContainer* Outputs[NumOutputs];
+		GetOutputs(Relationship, Outputs);
+
+		for (int32 OutputIdx = 0; OutputIdx < NumOutputs; ++OutputIdx)
+		{
+			MergedOutputs[OutputIdx].AppendTags(*Outputs[OutputIdx]);
+		}
+
+		Merged.ActionCancel.AppendTags(Relationship.AbilityTagsToCancel);
+	}
+
+	auto AddToPool = [this](const FGameplayTagContainer& Container) -> int32
+	{
+		if (Container.IsEmpty())
+		{
+			return 0;
+		}
+
+		const int32 ExistingIdx = ContainerPool.IndexOfByKey(Container);
+		return (ExistingIdx != INDEX_NONE) ? ExistingIdx : ContainerPool.Add(Container);
+	};
+
+	Entries.Reserve(MergedByTag.Num());
+	for (const TPair<FGameplayTag, FMergedOutputs>& Pair : MergedByTag)
+	{
+		FModularCompiledTagRelationshipEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.AbilityTag = Pair.Key;
+
+		// Pre-expand the partial relationships of all parent tags, so evaluating only needs the closest entry
+		FGameplayTagContainer ExpandedPartial[NumOutputs];
+		for (int32 OutputIdx = 0; OutputIdx < NumOutputs; ++OutputIdx)
+		{
+			ExpandedPartial[OutputIdx] = Pair.Value.Partial[OutputIdx];
+		}
+
+		for (const FGameplayTag& ParentTag : Pair.Key.GetGameplayTagParents())
+		{
+			const FMergedOutputs* ParentMerged = (ParentTag != Pair.Key) ? MergedByTag.Find(ParentTag) : nullptr;
+			if (ParentMerged == nullptr)
+			{
+				continue;
+			}
+
+			for (int32 OutputIdx = 0; OutputIdx < NumOutputs; ++OutputIdx)
+			{
+				ExpandedPartial[OutputIdx].AppendTags(ParentMerged->Partial[OutputIdx]);
+			}
+		}
+
+		for (int32 OutputIdx = 0; OutputIdx < NumOutputs; ++OutputIdx)
+		{
+			Entry.ExactOutputs[OutputIdx] = AddToPool(Pair.Value.Exact[OutputIdx]);
+			Entry.PartialOutputs[OutputIdx] = AddToPool(ExpandedPartial[OutputIdx]);
+		}
+
+		Entry.ActionCancelTags = AddToPool(Pair.Value.ActionCancel);
+	}
+
+	BuildEntryIndices();
+}
+
+void FModularCompiledTagRelationshipTable::BuildEntryIndices()
+{
+	using namespace ModularTagRelationship;
+
+	EntryIndices.Reset();
+	EntryIndices.Reserve(Entries.Num());
+
+	auto IsValidEntry = [this](const FModularCompiledTagRelationshipEntry& Entry)
+	{
+		for (int32 OutputIdx = 0; OutputIdx < NumOutputs; ++OutputIdx)
+		{
+			if (!ContainerPool.IsValidIndex(Entry.ExactOutputs[OutputIdx]) || !ContainerPool.IsValidIndex(Entry.PartialOutputs[OutputIdx]))
+			{
+				return false;
+			}
+		}
+
+		return ContainerPool.IsValidIndex(Entry.ActionCancelTags);
+	};
+
+	for (int32 EntryIdx = 0; EntryIdx < Entries.Num(); ++EntryIdx)
+	{
+		const FModularCompiledTagRelationshipEntry& Entry = Entries[EntryIdx];
+		if (!IsValidEntry(Entry))
+		{
+			ABILITY_LOG(Error, TEXT("%hs: Compiled entry of [%s] references an invalid container, discarding the table."), __func__, *Entry.AbilityTag.ToString());
+
+			ContainerPool.Reset();
+			Entries.Reset();
+			EntryIndices.Reset();
+			return;
+		}
+
+		EntryIndices.Add(Entry.AbilityTag, EntryIdx);
+	}
+}
+
+void FModularCompiledTagRelationshipTable::Evaluate(
 	const FGameplayTagContainer& AbilityTags,
-	FGameplayTagContainer* OutTagsToBlock,
-	FGameplayTagContainer* OutTagsToCancel) const
+	FModularAbilityTagRelationshipResult& OutResult) const
 {
-	for (int i = 0; i < AbilityTagRelationships.Num(); i++)
+	using namespace ModularTagRelationship;
+
+	FGameplayTagContainer* Outputs[NumOutputs];
+	GetOutputs(OutResult, Outputs);
+
+	for (const FGameplayTag& Tag : AbilityTags)
 	{
-		const auto& Relationship = AbilityTagRelationships[i];
-		const bool bTagMatches = Relationship.bMatchPartialTag
-			? AbilityTags.HasTag(Relationship.AbilityTag)
-			: AbilityTags.HasTagExact(Relationship.AbilityTag);
-		
-		if (bTagMatches)
+		// The closest entry already contains the partial relationships of all parent tags above it
+		for (FGameplayTag CurrentTag = Tag; CurrentTag.IsValid(); CurrentTag = CurrentTag.RequestDirectParent())
 		{
-			if (OutTagsToBlock)
+			const FModularCompiledTagRelationshipEntry* Entry = FindEntry(CurrentTag);
+			if (Entry == nullptr)
 			{
-				OutTagsToBlock->AppendTags(Relationship.AbilityTagsToBlock);
+				continue;
 			}
 
-			if (OutTagsToCancel)
+			const bool bExactMatch = (CurrentTag == Tag);
+			for (int32 OutputIdx = 0; OutputIdx < NumOutputs; ++OutputIdx)
 			{
-				OutTagsToCancel->AppendTags(Relationship.AbilityTagsToCancel);
+				if (bExactMatch)
+				{
+					Outputs[OutputIdx]->AppendTags(ContainerPool[Entry->ExactOutputs[OutputIdx]]);
+				}
+
+				Outputs[OutputIdx]->AppendTags(ContainerPool[Entry->PartialOutputs[OutputIdx]]);
 			}
+
+			break;
 		}
 	}
 }
 
-void UModularAbilityTagRelationshipMapping::GetActivationRequiredAndBlockedTags(
+//////////////////////////////////////////////////////////////////////////
+/// UModularAbilityTagRelationshipMapping
+
+UModularAbilityTagRelationshipMapping::UModularAbilityTagRelationshipMapping()
+{
+}
+
+void UModularAbilityTagRelationshipMapping::PostLoad()
+{
+	Super::PostLoad();
+
+	CompileRelationships();
+}
+
+#if WITH_EDITOR
+void UModularAbilityTagRelationshipMapping::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	CompileRelationships();
+}
+
+void UModularAbilityTagRelationshipMapping::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	// Only cooked mappings carry the table, editor assets are always compiled from their relationships
+	CookedTable = FModularCompiledTagRelationshipTable();
+
+	if (SaveContext.IsCooking())
+	{
+		TArray<FModularAbilityTagRelationship> Relationships;
+		TSet<const UModularAbilityTagRelationshipMapping*> VisitedMappings;
+		GatherRelationships(Relationships, VisitedMappings);
+
+		CookedTable.Build(Relationships);
+
+		ABILITY_LOG(Verbose, TEXT("%hs: Compiled [%s] into %d entries and %d containers."), __func__, *GetPathName(), CookedTable.Entries.Num(), CookedTable.ContainerPool.Num());
+	}
+}
+#endif
+
+UModularAbilityTagRelationshipMapping* UModularAbilityTagRelationshipMapping::CreateMergedMapping(
+	UObject* Outer,
+	TConstArrayView<UModularAbilityTagRelationshipMapping*> Mappings)
+{
+	UModularAbilityTagRelationshipMapping* MergedMapping = NewObject<UModularAbilityTagRelationshipMapping>(Outer ? Outer : GetTransientPackage());
+
+	for (UModularAbilityTagRelationshipMapping* Mapping : Mappings)
+	{
+		if (Mapping == nullptr)
+		{
+			continue;
+		}
+
+		MergedMapping->IncludedMappings.Add(Mapping);
+
+		if (Mapping->EvaluationMode == EModularTagRelationshipEvaluation::Bitmask)
+		{
+			MergedMapping->EvaluationMode = EModularTagRelationshipEvaluation::Bitmask;
+		}
+	}
+
+	MergedMapping->CompileRelationships();
+	return MergedMapping;
+}
+
+void UModularAbilityTagRelationshipMapping::GatherRelationships(
+	TArray<FModularAbilityTagRelationship>& OutRelationships,
+	TSet<const UModularAbilityTagRelationshipMapping*>& VisitedMappings) const
+{
+	bool bAlreadyVisited = false;
+	VisitedMappings.Add(this, &bAlreadyVisited);
+
+	if (bAlreadyVisited)
+	{
+		return;
+	}
+
+	OutRelationships.Append(AbilityTagRelationships);
+
+	for (const UModularAbilityTagRelationshipMapping* IncludedMapping : IncludedMappings)
+	{
+		if (IncludedMapping)
+		{
+			IncludedMapping->GatherRelationships(OutRelationships, VisitedMappings);
+		}
+	}
+}
+
+void UModularAbilityTagRelationshipMapping::CompileRelationships()
+{
+	// Cooked mappings already carry the merged relationships in their table
+	const bool bUseCookedTable = UsesCookedTable();
+	if (bUseCookedTable)
+	{
+		CookedTable.BuildEntryIndices();
+		MergedRelationships.Reset();
+	}
+	else if (!IncludedMappings.IsEmpty())
+	{
+		TSet<const UModularAbilityTagRelationshipMapping*> VisitedMappings;
+		MergedRelationships.Reset();
+		GatherRelationships(MergedRelationships, VisitedMappings);
+	}
+
+	{
+		FWriteScopeLock WriteLock(CachedResultsLock);
+		CachedResults.Reset();
+
+		CancelTagsByActionTag.Reset();
+		if (bUseCookedTable)
+		{
+			for (const FModularCompiledTagRelationshipEntry& Entry : CookedTable.Entries)
+			{
+				if (Entry.ActionCancelTags != 0)
+				{
+					CancelTagsByActionTag.Add(Entry.AbilityTag, CookedTable.ContainerPool[Entry.ActionCancelTags]);
+				}
+			}
+		}
+		else
+		{
+			for (const FModularAbilityTagRelationship& Relationship : GetRelationships())
+			{
+				if (Relationship.AbilityTag.IsValid() && !Relationship.AbilityTagsToCancel.IsEmpty())
+				{
+					CancelTagsByActionTag.FindOrAdd(Relationship.AbilityTag).AppendTags(Relationship.AbilityTagsToCancel);
+				}
+			}
+		}
+
+		bRelationshipsCompiled = true;
+		CompileSerial = ++ModularTagRelationship::NextCompileSerial;
+	}
+
+	CompiledBits = FCompiledRelationshipBits();
+	if (bUseCookedTable)
+	{
+		// Results are resolved from the table on first use, nothing left to compile
+		return;
+	}
+
+	if (EvaluationMode == EModularTagRelationshipEvaluation::Bitmask)
+	{
+		CompileRelationshipBits();
+	}
+
+	// Most abilities carry a single ability tag, so resolve those right away
+	for (const FModularAbilityTagRelationship& Relationship : GetRelationships())
+	{
+		if (Relationship.AbilityTag.IsValid())
+		{
+			GetRelationshipResult(FGameplayTagContainer(Relationship.AbilityTag));
+		}
+	}
+}
+
+const FModularAbilityTagRelationshipResult& UModularAbilityTagRelationshipMapping::GetRelationshipResult(
+	const FGameplayTagContainer& AbilityTags) const
+{
+	{
+		FReadScopeLock ReadLock(CachedResultsLock);
+		if (const TUniquePtr<FModularAbilityTagRelationshipResult>* Result = CachedResults.Find(AbilityTags))
+		{
+			return **Result;
+		}
+	}
+
+	TUniquePtr<FModularAbilityTagRelationshipResult> NewResult = MakeUnique<FModularAbilityTagRelationshipResult>();
+	EvaluateRelationships(AbilityTags, *NewResult);
+
+	FWriteScopeLock WriteLock(CachedResultsLock);
+
+	// Someone else may have resolved it in the meantime
+	if (const TUniquePtr<FModularAbilityTagRelationshipResult>* Result = CachedResults.Find(AbilityTags))
+	{
+		return **Result;
+	}
+
+	return *CachedResults.Add(AbilityTags, MoveTemp(NewResult));
+}
+
+void UModularAbilityTagRelationshipMapping::CompileRelationshipBits()
+{
+	using namespace ModularTagRelationship;
+
+	FCompiledRelationshipBits& Bits = CompiledBits;
+
+	// Bits are handed out by the mapping itself, net indices get reassigned whenever tags are added at runtime
+	auto AddTagBit = [&Bits](const FGameplayTag& Tag)
+	{
+		if (Tag.IsValid() && !Bits.TagBits.Contains(Tag))
+		{
+			Bits.TagBits.Add(Tag, Bits.BitTags.Add(Tag));
+		}
+	};
+
+	const TArray<FModularAbilityTagRelationship>& Relationships = GetRelationships();
+	for (const FModularAbilityTagRelationship& Relationship : Relationships)
+	{
+		AddTagBit(Relationship.AbilityTag);
+
+		for (const FGameplayTagContainer* Container : { &Relationship.AbilityTagsToBlock, &Relationship.AbilityTagsToCancel, &Relationship.ActivationRequiredTags, &Relationship.ActivationBlockedTags })
+		{
+			for (const FGameplayTag& Tag : *Container)
+			{
+				AddTagBit(Tag);
+			}
+		}
+	}
+
+	Bits.NumWords = (Bits.BitTags.Num() + 63) >> 6;
+	Bits.MatchIndices.Reset(Relationships.Num());
+	Bits.MatchPartial.Init(false, Relationships.Num());
+	Bits.OutputWords.SetNumZeroed(Relationships.Num() * NumOutputs * Bits.NumWords);
+
+	for (int32 Idx = 0; Idx < Relationships.Num(); ++Idx)
+	{
+		const FModularAbilityTagRelationship& Relationship = Relationships[Idx];
+
+		Bits.MatchIndices.Add(Relationship.AbilityTag.IsValid() ? Bits.TagBits.FindChecked(Relationship.AbilityTag) : INDEX_NONE);
+		Bits.MatchPartial[Idx] = Relationship.bMatchPartialTag;
+
+		const FGameplayTagContainer* Outputs[NumOutputs];
+		GetOutputs(Relationship, Outputs);
+
+		for (int32 OutputIdx = 0; OutputIdx < NumOutputs; ++OutputIdx)
+		{
+			TArrayView<uint64> OutputWords(&Bits.OutputWords[(Idx * NumOutputs + OutputIdx) * Bits.NumWords], Bits.NumWords);
+
+			for (const FGameplayTag& Tag : *Outputs[OutputIdx])
+			{
+				SetBit(OutputWords, Bits.TagBits.FindChecked(Tag));
+			}
+		}
+	}
+
+	Bits.bValid = true;
+}
+
+void UModularAbilityTagRelationshipMapping::EvaluateRelationships(
 	const FGameplayTagContainer& AbilityTags,
-	FGameplayTagContainer* OutActivationRequiredTags,
-	FGameplayTagContainer* OutActivationBlockedTags) const
+	FModularAbilityTagRelationshipResult& OutResult) const
 {
-	for (int i = 0; i < AbilityTagRelationships.Num(); i++)
+	if (UsesCookedTable())
+	{
+		CookedTable.Evaluate(AbilityTags, OutResult);
+		return;
+	}
+
+	if (CompiledBits.bValid)
 	{
-		const auto& Relationship = AbilityTagRelationships[i];
+		EvaluateRelationshipsBitmask(AbilityTags, OutResult);
+		return;
+	}
+
+	const TArray<FModularAbilityTagRelationship>& Relationships = GetRelationships();
+	for (int i = 0; i < Relationships.Num(); i++)
+	{
+		const auto& Relationship = Relationships[i];
 		const bool bTagMatches = Relationship.bMatchPartialTag
 			? AbilityTags.HasTag(Relationship.AbilityTag)
 			: AbilityTags.HasTagExact(Relationship.AbilityTag);
 
 		if (bTagMatches)
 		{
-			if (OutActivationRequiredTags)
+			OutResult.TagsToBlock.AppendTags(Relationship.AbilityTagsToBlock);
+			OutResult.TagsToCancel.AppendTags(Relationship.AbilityTagsToCancel);
+			OutResult.ActivationRequiredTags.AppendTags(Relationship.ActivationRequiredTags);
+			OutResult.ActivationBlockedTags.AppendTags(Relationship.ActivationBlockedTags);
+		}
+	}
+}
+
+void UModularAbilityTagRelationshipMapping::EvaluateRelationshipsBitmask(
+	const FGameplayTagContainer& AbilityTags,
+	FModularAbilityTagRelationshipResult& OutResult) const
+{
+	using namespace ModularTagRelationship;
+
+	const int32 NumWords = CompiledBits.NumWords;
+
+	// Ability tags as is for exact matches, and with all their parents for partial matches
+	TArray<uint64, TInlineAllocator<16>> ExactWords;
+	TArray<uint64, TInlineAllocator<16>> ExpandedWords;
+	ExactWords.SetNumZeroed(NumWords);
+	ExpandedWords.SetNumZeroed(NumWords);
+
+	for (const FGameplayTag& Tag : AbilityTags)
+	{
+		// Tags that none of the relationships use have no bit and can't match anything
+		if (const int32* Bit = CompiledBits.TagBits.Find(Tag))
+		{
+			SetBit(ExactWords, *Bit);
+		}
+
+		for (const FGameplayTag& ParentTag : Tag.GetGameplayTagParents())
+		{
+			if (const int32* ParentBit = CompiledBits.TagBits.Find(ParentTag))
 			{
-				OutActivationRequiredTags->AppendTags(Relationship.ActivationRequiredTags);
+				SetBit(ExpandedWords, *ParentBit);
 			}
+		}
+	}
+
+	TArray<uint64, TInlineAllocator<64>> ResultWords;
+	ResultWords.SetNumZeroed(NumOutputs * NumWords);
+
+	const int32 RowWords = NumOutputs * NumWords;
+	for (int32 Idx = 0; Idx < CompiledBits.MatchIndices.Num(); ++Idx)
+	{
+		const int32 MatchIndex = CompiledBits.MatchIndices[Idx];
+		const TConstArrayView<uint64> MatchWords = CompiledBits.MatchPartial[Idx] ? ExpandedWords : ExactWords;
+		if ((MatchIndex == INDEX_NONE) || !TestBit(MatchWords, MatchIndex))
+		{
+			continue;
+		}
 
-			if (OutActivationBlockedTags)
+		const uint64* RESTRICT Row = &CompiledBits.OutputWords[Idx * RowWords];
+		uint64* RESTRICT Result = ResultWords.GetData();
+		for (int32 WordIdx = 0; WordIdx < RowWords; ++WordIdx)
+		{
+			Result[WordIdx] |= Row[WordIdx];
+		}
+	}
+
+	FGameplayTagContainer* Outputs[NumOutputs];
+	GetOutputs(OutResult, Outputs);
+
+	for (int32 OutputIdx = 0; OutputIdx < NumOutputs; ++OutputIdx)
+	{
+		for (int32 WordIdx = 0; WordIdx < NumWords; ++WordIdx)
+		{
+			uint64 Word = ResultWords[OutputIdx * NumWords + WordIdx];
+			while (Word)
 			{
-				OutActivationBlockedTags->AppendTags(Relationship.ActivationBlockedTags);
+				const int32 Bit = WordIdx * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+				Outputs[OutputIdx]->AddTag(CompiledBits.BitTags[Bit]);
+				Word &= Word - 1;
 			}
 		}
 	}
 }
 
+void UModularAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(
+	const FGameplayTagContainer& AbilityTags,
+	FGameplayTagContainer* OutTagsToBlock,
+	FGameplayTagContainer* OutTagsToCancel) const
+{
+	const FModularAbilityTagRelationshipResult& Result = GetRelationshipResult(AbilityTags);
+
+	if (OutTagsToBlock)
+	{
+		OutTagsToBlock->AppendTags(Result.TagsToBlock);
+	}
+
+	if (OutTagsToCancel)
+	{
+		OutTagsToCancel->AppendTags(Result.TagsToCancel);
+	}
+}
+
+void UModularAbilityTagRelationshipMapping::GetActivationRequiredAndBlockedTags(
+	const FGameplayTagContainer& AbilityTags,
+	FGameplayTagContainer* OutActivationRequiredTags,
+	FGameplayTagContainer* OutActivationBlockedTags) const
+{
+	const FModularAbilityTagRelationshipResult& Result = GetRelationshipResult(AbilityTags);
+
+	if (OutActivationRequiredTags)
+	{
+		OutActivationRequiredTags->AppendTags(Result.ActivationRequiredTags);
+	}
+
+	if (OutActivationBlockedTags)
+	{
+		OutActivationBlockedTags->AppendTags(Result.ActivationBlockedTags);
+	}
+}
+
 bool UModularAbilityTagRelationshipMapping::IsAbilityCancelledByTag(
 	const FGameplayTagContainer& AbilityTags,
 	const FGameplayTag& ActionTag) const
 {
-	for (int i = 0; i < AbilityTagRelationships.Num(); i++)
+	if (bRelationshipsCompiled)
+	{
+		FReadScopeLock ReadLock(CachedResultsLock);
+		const FGameplayTagContainer* CancelTags = CancelTagsByActionTag.Find(ActionTag);
+		return CancelTags && CancelTags->HasAny(AbilityTags);
+	}
+
+	const TArray<FModularAbilityTagRelationship>& Relationships = GetRelationships();
+	for (int i = 0; i < Relationships.Num(); i++)
 	{
-		const auto& Relationship = AbilityTagRelationships[i];
+		const auto& Relationship = Relationships[i];
 
 		if (Relationship.AbilityTag == ActionTag && Relationship.AbilityTagsToCancel.HasAny(AbilityTags))
 		{
@@ -4,6 +4,8 @@
 #include "Tasks/AbilityTask_WaitForEnhancedInput.h"
 
 #include "EnhancedInputComponent.h"
+#include "ModularAbilitySystemComponent.h"
+#include "Input/ModularAbilityInputRouter.h"
 
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(AbilityTask_WaitForEnhancedInput)
@@ -40,6 +42,20 @@ void UAbilityTask_WaitForEnhancedInput::Activate()
 		return;
 	}
 
+	// Share the input action bindings with all other tasks of the ability system, if possible
+	if (UModularAbilitySystemComponent* ModularAbilitySystem = Cast<UModularAbilitySystemComponent>(AbilitySystemComponent.Get()))
+	{
+		InputRouter = ModularAbilitySystem->GetInputRouter();
+		InputRouterHandle = InputRouter->Subscribe(
+			InputAction.Get(),
+			FModularInputActionEventDelegate::CreateUObject(this, &ThisClass::HandleRoutedInputEvent));
+
+		if (InputRouterHandle.IsValid())
+		{
+			return;
+		}
+	}
+
 	EnhancedInput = Cast<UEnhancedInputComponent>(PC->InputComponent);
 	if (EnhancedInput.IsValid())
 	{
@@ -63,6 +79,12 @@ FString UAbilityTask_WaitForEnhancedInput::GetDebugString() const
 
 void UAbilityTask_WaitForEnhancedInput::OnDestroy(bool bInOwnerFinished)
 {
+	if (InputRouter.IsValid())
+	{
+		InputRouter->Unsubscribe(InputAction.Get(), InputRouterHandle);
+		InputRouterHandle.Reset();
+	}
+
 	if (EnhancedInput.IsValid())
 	{
 		EnhancedInput->ClearBindingsForObject(this);
@@ -128,3 +150,27 @@ void UAbilityTask_WaitForEnhancedInput::HandleInputCompleted(const FInputActionV
 	bHasBeenTriggered = true;
 	OnInputCompleted.Broadcast(ActionValue);
 }
+
+void UAbilityTask_WaitForEnhancedInput::HandleRoutedInputEvent(ETriggerEvent TriggerEvent, const FInputActionValue& ActionValue)
+{
+	switch (TriggerEvent)
+	{
+	case ETriggerEvent::Started:
+		HandleInputStarted(ActionValue);
+		break;
+	case ETriggerEvent::Ongoing:
+		HandleInputOngoing(ActionValue);
+		break;
+	case ETriggerEvent::Triggered:
+		HandleInputTriggered(ActionValue);
+		break;
+	case ETriggerEvent::Canceled:
+		HandleInputCanceled(ActionValue);
+		break;
+	case ETriggerEvent::Completed:
+		HandleInputCompleted(ActionValue);
+		break;
+	default:
+		break;
+	}
+}
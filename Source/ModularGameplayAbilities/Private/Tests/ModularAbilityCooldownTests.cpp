@@ -0,0 +1,153 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+#include "Cooldowns/ModularAbilityCharges.h"
+#include "Cooldowns/ModularCooldownLedger.h"
+#include "Misc/AutomationTest.h"
+#include "NativeGameplayTags.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ModularAbilityCooldownTests
+{
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Cooldown, "Test.ModularAbilities.Cooldown");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Cooldown_Fire, "Test.ModularAbilities.Cooldown.Fire");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Cooldown_Ice, "Test.ModularAbilities.Cooldown.Ice");
+
+	static FModularAbilityChargeEntry MakeChargeEntry(int32 MaxCharges, float RechargeDuration)
+	{
+		return FModularAbilityChargeEntry(FGameplayAbilitySpecHandle(), MaxCharges, RechargeDuration);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModularAbilityChargesTest, "ModularGameplayAbilities.Cooldowns.Charges",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FModularAbilityChargesTest::RunTest(const FString& Parameters)
+{
+	using namespace ModularAbilityCooldownTests;
+
+	FModularAbilityChargeEntry Entry = MakeChargeEntry(3, 2.f);
+	TestEqual(TEXT("Unused entry has all charges"), Entry.GetCharges(10.0), 3);
+	TestEqual(TEXT("Unused entry has no recharge pending"), Entry.GetTimeUntilNextCharge(10.0), 0.f);
+
+	Entry.ConsumeCharge(10.0);
+	TestEqual(TEXT("First consume queues a single recharge"), Entry.FullyChargedTime, 12.0);
+	TestEqual(TEXT("One charge is missing after consuming one"), Entry.GetCharges(10.0), 2);
+	TestEqual(TEXT("The charge is back after a full recharge"), Entry.GetTimeUntilNextCharge(10.0), 2.f);
+	TestEqual(TEXT("The charge is still missing right before it recharged"), Entry.GetCharges(11.999), 2);
+	TestEqual(TEXT("The charge is back exactly when it recharged"), Entry.GetCharges(12.0), 3);
+
+	// Charges recharge one after another, so every consumed charge queues behind the missing ones
+	Entry.ConsumeCharge(10.0);
+	Entry.ConsumeCharge(10.0);
+	TestEqual(TEXT("All charges consumed"), Entry.GetCharges(10.0), 0);
+	TestEqual(TEXT("Recharges are queued"), Entry.FullyChargedTime, 16.0);
+	TestEqual(TEXT("First charge is back after one recharge"), Entry.GetTimeUntilNextCharge(10.0), 2.f);
+	TestEqual(TEXT("No charge right before the first recharge"), Entry.GetCharges(11.999), 0);
+	TestEqual(TEXT("First charge back on its boundary"), Entry.GetCharges(12.0), 1);
+	TestEqual(TEXT("Second charge back on its boundary"), Entry.GetCharges(14.0), 2);
+	TestEqual(TEXT("Next charge is half way through its recharge"), Entry.GetTimeUntilNextCharge(13.0), 1.f);
+	TestEqual(TEXT("All charges back"), Entry.GetCharges(16.0), 3);
+	TestEqual(TEXT("Nothing left to recharge"), Entry.GetTimeUntilNextCharge(16.0), 0.f);
+
+	// Consuming once fully recharged starts from the current time again
+	Entry.ConsumeCharge(20.0);
+	TestEqual(TEXT("Consume after a full recharge starts from now"), Entry.FullyChargedTime, 22.0);
+	TestEqual(TEXT("Only the new charge is missing"), Entry.GetCharges(20.0), 2);
+
+	FModularAbilityChargeEntry NoRecharge = MakeChargeEntry(2, 0.f);
+	NoRecharge.ConsumeCharge(10.0);
+	TestEqual(TEXT("Charges without recharge duration are always available"), NoRecharge.GetCharges(10.0), 2);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModularAbilityPredictedChargesTest, "ModularGameplayAbilities.Cooldowns.PredictedCharges",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FModularAbilityPredictedChargesTest::RunTest(const FString& Parameters)
+{
+	using namespace ModularAbilityCooldownTests;
+
+	// The client predicted two consumes, its estimate of the server time is slightly ahead
+	FModularAbilityChargeEntry Predicted = MakeChargeEntry(3, 2.f);
+	Predicted.ConsumeCharge(10.0);
+	Predicted.ConsumeCharge(10.0);
+
+	FModularAbilityChargeEntry Replicated = MakeChargeEntry(3, 2.f);
+	Replicated.ConsumeCharge(9.9);
+	TestFalse(TEXT("Prediction is kept while a predicted consume is still in flight"), Replicated.HasCaughtUpWith(Predicted));
+
+	Replicated.ConsumeCharge(9.9);
+	TestTrue(TEXT("Prediction is cleared once the server consumed every predicted charge"), Replicated.HasCaughtUpWith(Predicted));
+
+	FModularAbilityChargeEntry Late = MakeChargeEntry(3, 2.f);
+	Late.ConsumeCharge(10.5);
+	Late.ConsumeCharge(10.5);
+	TestTrue(TEXT("Prediction is cleared if the server consumed later than predicted"), Late.HasCaughtUpWith(Predicted));
+
+	// Exactly half a recharge of slack for the server time estimate
+	FModularAbilityChargeEntry Boundary = MakeChargeEntry(3, 2.f);
+	Boundary.FullyChargedTime = Predicted.FullyChargedTime - 1.0;
+	TestTrue(TEXT("Prediction is cleared at half a recharge of slack"), Boundary.HasCaughtUpWith(Predicted));
+
+	Boundary.FullyChargedTime = Predicted.FullyChargedTime - 1.01;
+	TestFalse(TEXT("Prediction is kept beyond half a recharge of slack"), Boundary.HasCaughtUpWith(Predicted));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModularCooldownLedgerTest, "ModularGameplayAbilities.Cooldowns.Ledger",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FModularCooldownLedgerTest::RunTest(const FString& Parameters)
+{
+	using namespace ModularAbilityCooldownTests;
+
+	FModularCooldownLedger Ledger;
+	Ledger.SetCooldown(TAG_Test_Cooldown_Fire, 20.0, 10.f);
+
+	const FModularCooldownEntry* FireEntry = Ledger.FindCooldown(TAG_Test_Cooldown_Fire, 19.9);
+	if (TestNotNull(TEXT("Cooldown is active before its end time"), FireEntry))
+	{
+		TestEqual(TEXT("End time is stored"), FireEntry->EndTime, 20.0);
+		TestEqual(TEXT("Duration is stored"), FireEntry->Duration, 10.f);
+	}
+
+	TestNull(TEXT("Cooldown has expired exactly at its end time"), Ledger.FindCooldown(TAG_Test_Cooldown_Fire, 20.0));
+	TestNull(TEXT("Only the exact tag is found"), Ledger.FindCooldown(TAG_Test_Cooldown, 10.0));
+
+	// Going on cooldown again updates the entry in place
+	Ledger.SetCooldown(TAG_Test_Cooldown_Fire, 25.0, 5.f);
+	TestEqual(TEXT("Entry is reused for the same tag"), Ledger.Entries.Num(), 1);
+	TestNotNull(TEXT("Renewed cooldown is active past the old end time"), Ledger.FindCooldown(TAG_Test_Cooldown_Fire, 22.0));
+
+	Ledger.SetCooldown(TAG_Test_Cooldown_Ice, 30.0, 20.f);
+
+	const FGameplayTagContainer ParentTags(TAG_Test_Cooldown);
+	const FModularCooldownEntry* LongestEntry = Ledger.FindLongestCooldown(ParentTags, 22.0);
+	if (TestNotNull(TEXT("Parent tag matches the cooldowns of its children"), LongestEntry))
+	{
+		TestTrue(TEXT("Longest cooldown is the one ending last"), LongestEntry->CooldownTag == TAG_Test_Cooldown_Ice);
+	}
+
+	TestNull(TEXT("No cooldown is active once all expired"), Ledger.FindLongestCooldown(ParentTags, 30.0));
+
+	TestEqual(TEXT("Next end time is the earliest active cooldown"), Ledger.GetNextEndTime(22.0), 25.0);
+	TestEqual(TEXT("Expired cooldowns are skipped for the next end time"), Ledger.GetNextEndTime(25.0), 30.0);
+	TestEqual(TEXT("Next end time is zero once all expired"), Ledger.GetNextEndTime(30.0), 0.0);
+
+	Ledger.RemoveCooldown(TAG_Test_Cooldown_Fire);
+	TestNull(TEXT("Removed cooldown isn't found"), Ledger.FindCooldown(TAG_Test_Cooldown_Fire, 22.0));
+	TestEqual(TEXT("Removed cooldown is dropped from the table"), Ledger.Entries.Num(), 1);
+
+	// End times stay exact once the server has been running for months, where a float only resolves whole seconds
+	const double LongRunningTime = 10000000.1;
+	Ledger.SetCooldown(TAG_Test_Cooldown_Fire, LongRunningTime + 0.25, 0.25f);
+	TestNotNull(TEXT("Short cooldown is active late in a long session"), Ledger.FindCooldown(TAG_Test_Cooldown_Fire, LongRunningTime + 0.2));
+	TestNull(TEXT("Short cooldown expires on time late in a long session"), Ledger.FindCooldown(TAG_Test_Cooldown_Fire, LongRunningTime + 0.25));
+
+	return true;
+}
+
+#endif
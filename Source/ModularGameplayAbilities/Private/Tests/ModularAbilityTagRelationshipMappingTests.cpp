@@ -0,0 +1,187 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+#include "ModularAbilityTagRelationshipMapping.h"
+#include "Misc/AutomationTest.h"
+#include "NativeGameplayTags.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ModularAbilityTagRelationshipTests
+{
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Action, "Test.ModularAbilities.Action");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Action_Attack, "Test.ModularAbilities.Action.Attack");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Action_Attack_Heavy, "Test.ModularAbilities.Action.Attack.Heavy");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Action_Move, "Test.ModularAbilities.Action.Move");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Action_Move_Sprint, "Test.ModularAbilities.Action.Move.Sprint");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_State_Armed, "Test.ModularAbilities.State.Armed");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_State_Stunned, "Test.ModularAbilities.State.Stunned");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_State_Dead, "Test.ModularAbilities.State.Dead");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Unrelated, "Test.ModularAbilities.Unrelated");
+
+	static FModularAbilityTagRelationship MakeRelationship(
+		const FGameplayTag& AbilityTag,
+		bool bMatchPartialTag,
+		const FGameplayTagContainer& TagsToBlock,
+		const FGameplayTagContainer& TagsToCancel,
+		const FGameplayTagContainer& RequiredTags,
+		const FGameplayTagContainer& BlockedTags)
+	{
+		FModularAbilityTagRelationship Relationship;
+		Relationship.AbilityTag = AbilityTag;
+		Relationship.bMatchPartialTag = bMatchPartialTag;
+		Relationship.AbilityTagsToBlock = TagsToBlock;
+		Relationship.AbilityTagsToCancel = TagsToCancel;
+		Relationship.ActivationRequiredTags = RequiredTags;
+		Relationship.ActivationBlockedTags = BlockedTags;
+		return Relationship;
+	}
+
+	/** Relationships of the base mapping: partial, exact and root level ones, so parent tags contribute to child results. */
+	static TArray<FModularAbilityTagRelationship> MakeBaseRelationships()
+	{
+		const FGameplayTagContainer None;
+
+		TArray<FModularAbilityTagRelationship> Relationships;
+		Relationships.Add(MakeRelationship(TAG_Test_Action_Attack, true, FGameplayTagContainer(TAG_Test_Action_Move), FGameplayTagContainer(TAG_Test_Action_Move_Sprint), FGameplayTagContainer(TAG_Test_State_Armed), None));
+		Relationships.Add(MakeRelationship(TAG_Test_Action_Attack_Heavy, false, FGameplayTagContainer(TAG_Test_Action_Attack), None, None, FGameplayTagContainer(TAG_Test_State_Stunned)));
+		Relationships.Add(MakeRelationship(TAG_Test_Action, true, None, None, None, FGameplayTagContainer(TAG_Test_State_Dead)));
+		return Relationships;
+	}
+
+	/** Relationships of the included mapping, overlapping the ability tags of the base mapping. */
+	static TArray<FModularAbilityTagRelationship> MakeIncludedRelationships()
+	{
+		const FGameplayTagContainer None;
+
+		TArray<FModularAbilityTagRelationship> Relationships;
+		Relationships.Add(MakeRelationship(TAG_Test_Action_Move, true, None, FGameplayTagContainer(TAG_Test_Action_Attack_Heavy), None, None));
+		Relationships.Add(MakeRelationship(TAG_Test_Action_Attack_Heavy, true, None, None, FGameplayTagContainer(TAG_Test_State_Armed), FGameplayTagContainer(TAG_Test_State_Stunned)));
+		Relationships.Add(MakeRelationship(TAG_Test_Action_Move_Sprint, false, FGameplayTagContainer(TAG_Test_Action_Attack), None, None, None));
+		return Relationships;
+	}
+
+	/** Mappings only expose their relationships to the editor, so the tests go through reflection. */
+	template<typename T>
+	static T& GetMappingProperty(UModularAbilityTagRelationshipMapping* Mapping, const TCHAR* PropertyName)
+	{
+		const FProperty* Property = FindFProperty<FProperty>(UModularAbilityTagRelationshipMapping::StaticClass(), PropertyName);
+		check(Property);
+		return *Property->ContainerPtrToValuePtr<T>(Mapping);
+	}
+
+	static UModularAbilityTagRelationshipMapping* MakeMapping(
+		TConstArrayView<FModularAbilityTagRelationship> Relationships,
+		EModularTagRelationshipEvaluation EvaluationMode,
+		TConstArrayView<UModularAbilityTagRelationshipMapping*> IncludedMappings = {})
+	{
+		UModularAbilityTagRelationshipMapping* Mapping = NewObject<UModularAbilityTagRelationshipMapping>(GetTransientPackage());
+		GetMappingProperty<TArray<FModularAbilityTagRelationship>>(Mapping, TEXT("AbilityTagRelationships")) = TArray<FModularAbilityTagRelationship>(Relationships);
+		GetMappingProperty<EModularTagRelationshipEvaluation>(Mapping, TEXT("EvaluationMode")) = EvaluationMode;
+
+		TArray<TObjectPtr<UModularAbilityTagRelationshipMapping>>& MappingIncludes = GetMappingProperty<TArray<TObjectPtr<UModularAbilityTagRelationshipMapping>>>(Mapping, TEXT("IncludedMappings"));
+		for (UModularAbilityTagRelationshipMapping* IncludedMapping : IncludedMappings)
+		{
+			MappingIncludes.Add(IncludedMapping);
+		}
+
+		Mapping->CompileRelationships();
+		return Mapping;
+	}
+
+	static bool ContainersMatch(const FGameplayTagContainer& A, const FGameplayTagContainer& B)
+	{
+		return (A.Num() == B.Num()) && A.HasAllExact(B);
+	}
+
+	static bool ResultsMatch(const FModularAbilityTagRelationshipResult& A, const FModularAbilityTagRelationshipResult& B)
+	{
+		return ContainersMatch(A.TagsToBlock, B.TagsToBlock)
+			&& ContainersMatch(A.TagsToCancel, B.TagsToCancel)
+			&& ContainersMatch(A.ActivationRequiredTags, B.ActivationRequiredTags)
+			&& ContainersMatch(A.ActivationBlockedTags, B.ActivationBlockedTags);
+	}
+
+	static FString DescribeResult(const FModularAbilityTagRelationshipResult& Result)
+	{
+		return FString::Printf(TEXT("Block [%s] Cancel [%s] Required [%s] Blocked [%s]"),
+			*Result.TagsToBlock.ToStringSimple(), *Result.TagsToCancel.ToStringSimple(),
+			*Result.ActivationRequiredTags.ToStringSimple(), *Result.ActivationBlockedTags.ToStringSimple());
+	}
+
+	/** Ability tag sets covering exact matches, parent matches, multiple tags, no tags and tags no relationship uses. */
+	static TArray<FGameplayTagContainer> MakeQueries()
+	{
+		TArray<FGameplayTagContainer> Queries;
+		Queries.Add(FGameplayTagContainer(TAG_Test_Action));
+		Queries.Add(FGameplayTagContainer(TAG_Test_Action_Attack));
+		Queries.Add(FGameplayTagContainer(TAG_Test_Action_Attack_Heavy));
+		Queries.Add(FGameplayTagContainer(TAG_Test_Action_Move));
+		Queries.Add(FGameplayTagContainer(TAG_Test_Action_Move_Sprint));
+		Queries.Add(FGameplayTagContainer::CreateFromArray(TArray<FGameplayTag>{ TAG_Test_Action_Attack_Heavy, TAG_Test_Action_Move_Sprint }));
+		Queries.Add(FGameplayTagContainer(TAG_Test_Unrelated));
+		Queries.Add(FGameplayTagContainer());
+		return Queries;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModularTagRelationshipEvaluatorsTest, "ModularGameplayAbilities.TagRelationshipMapping.EvaluatorsMatch",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FModularTagRelationshipEvaluatorsTest::RunTest(const FString& Parameters)
+{
+	using namespace ModularAbilityTagRelationshipTests;
+
+	const TArray<FModularAbilityTagRelationship> BaseRelationships = MakeBaseRelationships();
+	const TArray<FModularAbilityTagRelationship> IncludedRelationships = MakeIncludedRelationships();
+
+	TArray<FModularAbilityTagRelationship> AllRelationships = BaseRelationships;
+	AllRelationships.Append(IncludedRelationships);
+
+	// Included through the asset, through a merged mapping, and in the cooked table
+	UModularAbilityTagRelationshipMapping* IncludedMapping = MakeMapping(IncludedRelationships, EModularTagRelationshipEvaluation::Linear);
+	UModularAbilityTagRelationshipMapping* LinearMapping = MakeMapping(BaseRelationships, EModularTagRelationshipEvaluation::Linear, { IncludedMapping });
+	UModularAbilityTagRelationshipMapping* BitmaskMapping = MakeMapping(BaseRelationships, EModularTagRelationshipEvaluation::Bitmask, { IncludedMapping });
+
+	UModularAbilityTagRelationshipMapping* BaseBitmaskMapping = MakeMapping(BaseRelationships, EModularTagRelationshipEvaluation::Bitmask);
+	UModularAbilityTagRelationshipMapping* MergedMapping = UModularAbilityTagRelationshipMapping::CreateMergedMapping(GetTransientPackage(), { BaseBitmaskMapping, IncludedMapping });
+
+	FModularCompiledTagRelationshipTable CookedTable;
+	CookedTable.Build(AllRelationships);
+
+	for (const FGameplayTagContainer& AbilityTags : MakeQueries())
+	{
+		const FModularAbilityTagRelationshipResult& LinearResult = LinearMapping->GetRelationshipResult(AbilityTags);
+		const FModularAbilityTagRelationshipResult& BitmaskResult = BitmaskMapping->GetRelationshipResult(AbilityTags);
+		const FModularAbilityTagRelationshipResult& MergedResult = MergedMapping->GetRelationshipResult(AbilityTags);
+
+		FModularAbilityTagRelationshipResult CookedResult;
+		CookedTable.Evaluate(AbilityTags, CookedResult);
+
+		const FString Query = AbilityTags.ToStringSimple();
+		TestTrue(FString::Printf(TEXT("Bitmask matches linear for [%s]: %s vs %s"), *Query, *DescribeResult(BitmaskResult), *DescribeResult(LinearResult)), ResultsMatch(BitmaskResult, LinearResult));
+		TestTrue(FString::Printf(TEXT("Cooked table matches linear for [%s]: %s vs %s"), *Query, *DescribeResult(CookedResult), *DescribeResult(LinearResult)), ResultsMatch(CookedResult, LinearResult));
+		TestTrue(FString::Printf(TEXT("Merged mapping matches linear for [%s]: %s vs %s"), *Query, *DescribeResult(MergedResult), *DescribeResult(LinearResult)), ResultsMatch(MergedResult, LinearResult));
+	}
+
+	// Make sure the evaluators agree on the right thing, the heavy attack collects its own, its parents' and the included relationships
+	FModularAbilityTagRelationshipResult Expected;
+	Expected.TagsToBlock = FGameplayTagContainer::CreateFromArray(TArray<FGameplayTag>{ TAG_Test_Action_Move, TAG_Test_Action_Attack });
+	Expected.TagsToCancel = FGameplayTagContainer(TAG_Test_Action_Move_Sprint);
+	Expected.ActivationRequiredTags = FGameplayTagContainer(TAG_Test_State_Armed);
+	Expected.ActivationBlockedTags = FGameplayTagContainer::CreateFromArray(TArray<FGameplayTag>{ TAG_Test_State_Stunned, TAG_Test_State_Dead });
+
+	const FModularAbilityTagRelationshipResult& HeavyResult = LinearMapping->GetRelationshipResult(FGameplayTagContainer(TAG_Test_Action_Attack_Heavy));
+	TestTrue(FString::Printf(TEXT("Heavy attack result: %s"), *DescribeResult(HeavyResult)), ResultsMatch(HeavyResult, Expected));
+
+	// Exact relationships must not apply to child tags
+	const FModularAbilityTagRelationshipResult& AttackResult = BitmaskMapping->GetRelationshipResult(FGameplayTagContainer(TAG_Test_Action_Attack));
+	TestFalse(TEXT("Exact heavy attack relationship doesn't apply to its parent"), AttackResult.ActivationBlockedTags.HasTagExact(TAG_Test_State_Stunned));
+
+	TestTrue(TEXT("Included cancel relationship is found"), LinearMapping->IsAbilityCancelledByTag(FGameplayTagContainer(TAG_Test_Action_Attack_Heavy), TAG_Test_Action_Move));
+	TestTrue(TEXT("Merged cancel relationship is found"), MergedMapping->IsAbilityCancelledByTag(FGameplayTagContainer(TAG_Test_Action_Attack_Heavy), TAG_Test_Action_Move));
+
+	return true;
+}
+
+#endif
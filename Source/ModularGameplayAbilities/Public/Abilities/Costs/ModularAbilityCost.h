@@ -14,6 +14,7 @@ class UGameplayAbility;
 class UModularGameplayAbility;
 struct FGameplayTagContainer;
 struct FGameplayAbilityActorInfo;
+struct FGameplayAttribute;
 
 /** Base struct for all per-ability costs that can be applied with the ability system. */
 USTRUCT(BlueprintType)
@@ -60,6 +61,14 @@ public:
 		// By default, we don't apply any cost.
 	}
 
+	/**
+	 * Gathers the attributes CheckCost depends on.
+	 * The ability system component watches them to know when the activatable abilities need to be re-evaluated.
+	 */
+	virtual void GetCostAttributes(TArray<FGameplayAttribute>& OutAttributes) const
+	{
+	}
+
 	/** Returns whether this cost should only be applied if this ability hits successfully. */
 	bool ShouldOnlyApplyCostOnHit() const { return bOnlyApplyCostOnHit; }
 
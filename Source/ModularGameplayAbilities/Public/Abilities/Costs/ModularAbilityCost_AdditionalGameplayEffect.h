@@ -25,6 +25,7 @@ public:
 	//~ Begin FModularAbilityCost Interface
 	virtual bool CheckCost(const UModularGameplayAbility* Ability, const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, FGameplayTagContainer* OptionalRelevantTags) const override;
 	virtual void ApplyCost(const UModularGameplayAbility* Ability, const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo) override;
+	virtual void GetCostAttributes(TArray<FGameplayAttribute>& OutAttributes) const override;
 	//~ End FModularAbilityCost Interface
 
 protected:
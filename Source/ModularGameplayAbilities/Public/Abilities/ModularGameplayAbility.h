@@ -20,6 +20,7 @@
 #include "ModularGameplayAbility.generated.h"
 
 class AAIController;
+class UModularAbilitySystemComponent;
 struct FModularAbilityCost;
 /**
  * Extended version of the UGameplayAbility
@@ -104,6 +105,28 @@ public:
 		return ExplicitCooldownDuration;
 	}
 
+	/** Returns the maximum number of charges of this ability at the given level. */
+	int32 GetMaxCharges(int32 AbilityLevel) const
+	{
+		return FMath::FloorToInt32(MaxCharges.GetValueAtLevel(AbilityLevel));
+	}
+
+	/** Returns true if this ability consumes charges instead of applying a cooldown at the given level. */
+	bool UsesCharges(int32 AbilityLevel) const
+	{
+		return GetMaxCharges(AbilityLevel) > 0 && ChargeRechargeDuration.GetValueAtLevel(AbilityLevel) > 0.0f;
+	}
+
+	/** Returns the cooldown group this ability shares its cooldown with, if any. */
+	const FGameplayTag& GetCooldownGroupTag() const
+	{
+		return CooldownGroupTag;
+	}
+
+	/** Returns the number of charges this ability currently has, or zero if it doesn't use charges. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = Ability)
+	int32 GetCurrentCharges() const;
+
 	/** Returns true if the requested activation group is a valid transition from the current activation group. */
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = Ability, meta = (ExpandBoolAsExecs = "ReturnValue"))
 	bool CanChangeActivationGroup(EGameplayAbilityActivationGroup::Type DesiredGroup) const;
@@ -115,6 +138,18 @@ public:
 	/** Tries to activate this ability on spawn. (For Passive abilities) */
 	virtual void TryActivateAbilityOnSpawn(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) const;
 
+	/**
+	 * Tries to activate this passive ability, if its net execution policy allows it to be activated locally.
+	 * Called on spawn and, if bActivateWhenRequiredTagsAdded is set, whenever one of the activation required tags got added to the owner.
+	 */
+	void TryActivatePassiveAbility(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) const;
+
+	/** Returns true if the owner has all activation required tags of this ability. Shared by all passive activation paths. */
+	bool HasPassiveActivationRequiredTags(const UAbilitySystemComponent& AbilitySystem) const;
+
+	/** Returns the tags that activate this passive ability once added to the owner. Empty unless bActivateWhenRequiredTagsAdded is set. */
+	const FGameplayTagContainer& GetPassiveActivationWatchedTags() const;
+
 	//~ Begin IGameplayTagAssetInterface Interface
 	virtual void GetOwnedGameplayTags(FGameplayTagContainer& TagContainer) const override;
 	//~ End IGameplayTagAssetInterface Interface
@@ -223,6 +258,8 @@ protected:
 
 	virtual bool CheckCooldown(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, FGameplayTagContainer* OptionalRelevantTags = nullptr) const override;
 	virtual void ApplyCooldown(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo) const override;
+	virtual float GetCooldownTimeRemaining(const FGameplayAbilityActorInfo* ActorInfo) const override;
+	virtual void GetCooldownTimeRemainingAndDuration(FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, float& TimeRemaining, float& CooldownDuration) const override;
 
 	virtual bool DoesAbilitySatisfyTagRequirements(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayTagContainer* SourceTags = nullptr, const FGameplayTagContainer* TargetTags = nullptr, FGameplayTagContainer* OptionalRelevantTags = nullptr) const override;
 
@@ -232,6 +269,7 @@ protected:
 	//~ Begin UObject Interface
 #if WITH_EDITOR
 	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 	//~ End UObject Interface
 
@@ -321,6 +359,10 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = Activation, meta = (DisplayName = "Activate if Tags Already Present"))
 	uint8 bActivateIfTagsAlreadyPresent : 1;
 
+	/** If true, the passive ability will also be activated whenever its activation required tags become present after spawn. */
+	UPROPERTY(EditDefaultsOnly, Category = Activation, meta = (EditConditionHides, EditCondition = "ActivationPolicy == EGameplayAbilityActivationPolicy::Passive"))
+	uint8 bActivateWhenRequiredTagsAdded : 1;
+
 	/** If true, extra information should be logged when this ability is canceled. This is temporary, used for tracking a bug. */
 	UPROPERTY(EditDefaultsOnly, Category = Activation, AdvancedDisplay)
 	uint8 bLogCancelation : 1;
@@ -375,6 +417,25 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Cooldowns|Explicit")
 	FGameplayTagContainer ExplicitCooldownAssetTags;
 
+	/**
+	 * Cooldown group this ability shares its cooldown with, e.g. all grenades.
+	 * If set, applying the cooldown puts the whole group on cooldown for the explicit cooldown duration, or the duration of the cooldown effect.
+	 * Requires a modular ability system component.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Cooldowns|Group")
+	FGameplayTag CooldownGroupTag;
+
+	/**
+	 * Number of charges of the ability. If greater than zero, each activation consumes a charge instead of applying the cooldown,
+	 * and the ability is only on cooldown while it has no charge left. Requires a modular ability system component.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Cooldowns|Charges")
+	FScalableFloat MaxCharges;
+
+	/** Time it takes to recharge a single charge. Charges recharge one after another. */
+	UPROPERTY(EditDefaultsOnly, Category = "Cooldowns|Charges")
+	FScalableFloat ChargeRechargeDuration;
+
 	// ----------------------------------------------------------------------------------------------------------------
 	//	Costs
 	// ----------------------------------------------------------------------------------------------------------------
@@ -428,4 +489,46 @@ private:
 	/** Flag to indicate if we need to resume any RVO avoidance once the ability is deactivated. */
 	UPROPERTY(Transient)
 	uint8 bPausedAnyAIBehaviorLogic:1 = false;
+
+	/** Makes a new cooldown spec of the given effect with the explicit cooldown tags applied. */
+	FGameplayEffectSpecHandle MakeExplicitCooldownSpec(const UGameplayEffect* CooldownEffectCDO, int32 AbilityLevel) const;
+
+	/**
+	 * Returns a copy of the explicit cooldown spec template of the given level, building the template on first use.
+	 * The copy gets a new effect context, source tags and set by caller magnitudes, so only the per level state is reused.
+	 */
+	FGameplayEffectSpecHandle MakeCooldownSpecFromTemplate(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const UGameplayEffect* CooldownEffectCDO, int32 AbilityLevel) const;
+
+	/** Records the applied cooldown in the cooldown cache of the owner and broadcasts OnApplyCooldownDelegate. */
+	void NotifyCooldownApplied(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, float Duration, const FGameplayTagContainer& CooldownTags) const;
+
+	/** Returns the owning ability system component if this ability uses charges at the given level, nullptr otherwise. */
+	UModularAbilitySystemComponent* GetChargeAbilitySystem(const FGameplayAbilityActorInfo* ActorInfo, int32 AbilityLevel) const;
+
+	/** Returns the owning ability system component if this ability belongs to a cooldown group, nullptr otherwise. */
+	UModularAbilitySystemComponent* GetCooldownGroupAbilitySystem(const FGameplayAbilityActorInfo* ActorInfo) const;
+
+	/** Evaluates the duration of the cooldown effect without applying it. */
+	float GetCooldownEffectDuration(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo& ActivationInfo, int32 AbilityLevel) const;
+
+	/** Returns the owning ability system component if it tracks cooldowns in its cooldown ledger, nullptr otherwise. */
+	UModularAbilitySystemComponent* GetCooldownLedgerAbilitySystem(const FGameplayAbilityActorInfo* ActorInfo) const;
+
+	/** Puts the given tags on cooldown in the cooldown ledger of the owner instead of applying a cooldown effect. */
+	void ApplyLedgerCooldown(UModularAbilitySystemComponent* AbilitySystem, const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo& ActivationInfo, const FGameplayTagContainer& CooldownTags, float Duration) const;
+
+	/** Returns the cooldown tags of the given ability level, building them on first use. Only called on the CDO. */
+	const FGameplayTagContainer* GetCooldownTagsForLevel(int32 AbilityLevel) const;
+
+	/** Gathers the cooldown tags of the given ability level from the cooldown effect and the explicit cooldown. */
+	void BuildCooldownTagsForLevel(int32 AbilityLevel, FGameplayTagContainer& OutCooldownTags) const;
+
+	/** Cooldown tags of each ability level, see GetCooldownTags. Only filled on the CDO, pointers stay valid for the lifetime of the CDO. */
+	mutable TMap<int32, TUniquePtr<FGameplayTagContainer>> CooldownTagsByLevel;
+
+	/** Guards CooldownTagsByLevel, as cooldown checks may run on any thread. */
+	mutable FRWLock CooldownTagsLock;
+
+	/** Explicit cooldown spec of each ability level, see MakeCooldownSpecFromTemplate. */
+	mutable TMap<int32, FGameplayEffectSpecHandle> CooldownSpecTemplates;
 };
@@ -0,0 +1,117 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayAbilitySpecHandle.h"
+#include "Net/Serialization/FastArraySerializer.h"
+
+#include "ModularAbilityCharges.generated.h"
+
+class UModularAbilitySystemComponent;
+struct FModularAbilityChargeList;
+
+/**
+ * Charge state of a single ability spec.
+ * Only stores the time at which all charges are back, so the current charges are derived from the time instead of being ticked.
+ */
+USTRUCT()
+struct FModularAbilityChargeEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+public:
+	FModularAbilityChargeEntry() = default;
+	FModularAbilityChargeEntry(const FGameplayAbilitySpecHandle InHandle, const int32 InMaxCharges, const float InRechargeDuration)
+		: Handle(InHandle)
+		, MaxCharges(InMaxCharges)
+		, RechargeDuration(InRechargeDuration)
+	{
+	}
+
+	//~ Begin FFastArraySerializerItem Interface
+	void PostReplicatedAdd(const FModularAbilityChargeList& InArraySerializer);
+	void PostReplicatedChange(const FModularAbilityChargeList& InArraySerializer);
+	//~ End FFastArraySerializerItem Interface
+
+	/** Returns the number of charges available at the given time. */
+	int32 GetCharges(const double Time) const;
+
+	/** Returns the time until the next charge is back, or zero if all charges are available. */
+	float GetTimeUntilNextCharge(const double Time) const;
+
+	/** Consumes a charge at the given time. Charges recharge one at a time, so the consumed charge is queued after all missing ones. */
+	void ConsumeCharge(const double Time)
+	{
+		FullyChargedTime = FMath::Max(FullyChargedTime, Time) + RechargeDuration;
+	}
+
+	/**
+	 * Returns true if this replicated state includes every charge the given predicted state consumed.
+	 * Each consume pushes the time by a full recharge, so half of it is enough slack for the server time estimate of the client.
+	 */
+	bool HasCaughtUpWith(const FModularAbilityChargeEntry& PredictedEntry) const
+	{
+		return FullyChargedTime >= PredictedEntry.FullyChargedTime - PredictedEntry.RechargeDuration * 0.5f;
+	}
+
+	/** The ability spec the charges belong to. */
+	UPROPERTY()
+	FGameplayAbilitySpecHandle Handle;
+
+	/** Maximum number of charges the ability had when a charge was last consumed. */
+	UPROPERTY()
+	int32 MaxCharges = 0;
+
+	/** Time it takes to recharge a single charge. */
+	UPROPERTY()
+	float RechargeDuration = 0.f;
+
+	/** Ledger time at which all charges are available again. */
+	UPROPERTY()
+	double FullyChargedTime = 0.0;
+};
+
+/** Charge states of all ability specs that consumed a charge. Specs that never consumed one have all of their charges. */
+USTRUCT()
+struct FModularAbilityChargeList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+public:
+	/** Returns the charge state of the given spec, or nullptr if it never consumed a charge. */
+	const FModularAbilityChargeEntry* Find(const FGameplayAbilitySpecHandle& Handle) const
+	{
+		return Entries.FindByPredicate([&Handle](const FModularAbilityChargeEntry& Entry)
+		{
+			return Entry.Handle == Handle;
+		});
+	}
+
+	/** Stores the charge state of its spec, replacing the previous one. */
+	void Set(const FModularAbilityChargeEntry& NewEntry);
+
+	/** Removes the charge state of the given spec. */
+	void Remove(const FGameplayAbilitySpecHandle& Handle);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FModularAbilityChargeEntry, FModularAbilityChargeList>(Entries, DeltaParams, *this);
+	}
+
+	/** The charge state of each spec. */
+	UPROPERTY()
+	TArray<FModularAbilityChargeEntry> Entries;
+
+	/** Component that owns this list. */
+	UModularAbilitySystemComponent* Owner = nullptr;
+};
+
+template<>
+struct TStructOpsTypeTraits<FModularAbilityChargeList> : public TStructOpsTypeTraitsBase2<FModularAbilityChargeList>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -0,0 +1,101 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Net/Serialization/FastArraySerializer.h"
+
+#include "ModularCooldownLedger.generated.h"
+
+class UModularAbilitySystemComponent;
+struct FModularCooldownLedger;
+
+/** Cooldown of a single cooldown tag in the cooldown ledger. */
+USTRUCT()
+struct FModularCooldownEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+public:
+	FModularCooldownEntry() = default;
+	FModularCooldownEntry(const FGameplayTag& InCooldownTag, const double InEndTime, const float InDuration)
+		: CooldownTag(InCooldownTag)
+		, EndTime(InEndTime)
+		, Duration(InDuration)
+	{
+	}
+
+	//~ Begin FFastArraySerializerItem Interface
+	void PostReplicatedAdd(const FModularCooldownLedger& InArraySerializer);
+	void PostReplicatedChange(const FModularCooldownLedger& InArraySerializer);
+	//~ End FFastArraySerializerItem Interface
+
+	/** Returns true if the cooldown hasn't ended at the given ledger time. */
+	bool IsActive(const double Time) const { return EndTime > Time; }
+
+	/** The tag that is on cooldown. */
+	UPROPERTY()
+	FGameplayTag CooldownTag;
+
+	/** Ledger time at which the cooldown ends. Double, as a float loses precision once the server has been running for a while. */
+	UPROPERTY()
+	double EndTime = 0.0;
+
+	/** Total duration of the cooldown. */
+	UPROPERTY()
+	float Duration = 0.f;
+};
+
+/**
+ * Flat table of cooldown end times per cooldown tag, used instead of cooldown gameplay effects.
+ * Entries are updated in place when the same tag goes on cooldown again, so the table never grows beyond the number of distinct cooldown tags.
+ */
+USTRUCT()
+struct FModularCooldownLedger : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+public:
+	/** Starts the cooldown of the given tag, replacing any cooldown the tag already has. */
+	void SetCooldown(const FGameplayTag& CooldownTag, const double EndTime, const float Duration);
+
+	/** Removes the cooldown of the given tag. */
+	void RemoveCooldown(const FGameplayTag& CooldownTag);
+
+	/** Returns the active cooldown of exactly the given tag, or nullptr if it isn't on cooldown. */
+	const FModularCooldownEntry* FindCooldown(const FGameplayTag& CooldownTag, const double Time) const
+	{
+		return Entries.FindByPredicate([&CooldownTag, Time](const FModularCooldownEntry& Entry)
+		{
+			return Entry.CooldownTag == CooldownTag && Entry.IsActive(Time);
+		});
+	}
+
+	/** Returns the active cooldown that ends last among the given tags and their children, or nullptr if none is active. */
+	const FModularCooldownEntry* FindLongestCooldown(const FGameplayTagContainer& CooldownTags, const double Time) const;
+
+	/** Returns the earliest end time of all cooldowns that are active at the given time, or zero if none is. */
+	double GetNextEndTime(const double Time) const;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FModularCooldownEntry, FModularCooldownLedger>(Entries, DeltaParams, *this);
+	}
+
+	/** The cooldown of each cooldown tag. */
+	UPROPERTY()
+	TArray<FModularCooldownEntry> Entries;
+
+	/** Component that owns this ledger. */
+	UModularAbilitySystemComponent* Owner = nullptr;
+};
+
+template<>
+struct TStructOpsTypeTraits<FModularCooldownLedger> : public TStructOpsTypeTraitsBase2<FModularCooldownLedger>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -0,0 +1,91 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputTriggers.h"
+#include "UObject/Object.h"
+
+#include "ModularAbilityInputRouter.generated.h"
+
+class UEnhancedInputComponent;
+class UInputAction;
+struct FInputActionInstance;
+struct FInputActionValue;
+
+/** Called for every trigger event of a routed input action. */
+DECLARE_DELEGATE_TwoParams(FModularInputActionEventDelegate, ETriggerEvent /*TriggerEvent*/, const FInputActionValue& /*ActionValue*/);
+
+/**
+ * Routes enhanced input action events to any number of subscribers, e.g. ability tasks.
+ * Each input action is bound once on the enhanced input component of the owning player controller and stays bound,
+ * so subscribing and unsubscribing never touches the binding list of the input component.
+ * The bindings move to the new input component whenever the actor info of the ability system is initialized, e.g. on possession.
+ */
+UCLASS(Within = ModularAbilitySystemComponent)
+class MODULARGAMEPLAYABILITIES_API UModularAbilityInputRouter : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Subscribes to all trigger events of the given input action.
+	 * @returns The handle to unsubscribe with, which is invalid if there is no enhanced input component to bind to.
+	 */
+	FDelegateHandle Subscribe(const UInputAction* InputAction, FModularInputActionEventDelegate&& Delegate);
+
+	/** Removes a subscription previously added through Subscribe. */
+	void Unsubscribe(const UInputAction* InputAction, FDelegateHandle Handle);
+
+	/** Removes all bindings from the input component and drops all subscribers. */
+	void Reset();
+
+	/** Moves all bindings over if the owning player controller or its input component changed. */
+	void RefreshInputComponent();
+
+	//~ Begin UObject Interface
+	virtual void BeginDestroy() override;
+	//~ End UObject Interface
+
+protected:
+	/** Subscribers of a single input action. */
+	struct FActionSubscribers
+	{
+		/** Subscribed delegates. Unbound entries were unsubscribed during a dispatch and get compacted afterward. */
+		TArray<FModularInputActionEventDelegate, TInlineAllocator<2>> Delegates;
+
+		/** Whether the action is bound on the current input component. */
+		bool bBound = false;
+	};
+
+	/** Returns the enhanced input component of the owning player controller, rebinding all actions if it changed. */
+	UEnhancedInputComponent* ResolveInputComponent();
+
+	/** Binds all trigger events of the action on the current input component. */
+	void BindAction(const UInputAction* InputAction, FActionSubscribers& Subscribers);
+
+	/** Handles any trigger event of any bound input action. */
+	void HandleActionEvent(const FInputActionInstance& ActionInstance);
+
+	/** Removes unsubscribed entries once no dispatch is in progress. */
+	void CompactSubscribers();
+
+protected:
+	/** Subscribers of each routed input action. */
+	TMap<TWeakObjectPtr<const UInputAction>, FActionSubscribers> ActionSubscribers;
+
+	/** Subscriptions added while dispatching, merged once the dispatch has finished. */
+	TArray<TPair<TWeakObjectPtr<const UInputAction>, FModularInputActionEventDelegate>> PendingSubscribers;
+
+	/** The input component all actions are currently bound on. */
+	TWeakObjectPtr<UEnhancedInputComponent> BoundInputComponent;
+
+	/** Depth of nested dispatches. Subscribers are only added or removed from the lists while this is zero. */
+	int32 DispatchDepth = 0;
+
+	/** Whether any subscriber was unsubscribed during a dispatch. */
+	bool bNeedsCompaction = false;
+
+	/** Whether the input component needs to be resolved again once the running dispatch has finished. */
+	bool bNeedsInputComponentRefresh = false;
+};
@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "ModularAbilitySystemComponent.h"
+#include "Engine/EngineBaseTypes.h"
 #include "Subsystems/WorldSubsystem.h"
 
 #include "ModularAbilitySubsystem.generated.h"
 
+class UModularAbilitySubsystem;
+
 /** Struct containing all abilities that are applied to all actors. */
 USTRUCT()
 struct FGloballyAppliedAbilities
@@ -40,6 +43,32 @@ public:
 	TMap<TObjectPtr<UModularAbilitySystemComponent>, FActiveGameplayEffectHandle> Handles;
 };
 
+/** Tick function that processes the ability input of all registered ability systems in one batch. */
+USTRUCT()
+struct FModularAbilityInputTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+public:
+	/** The subsystem that owns this tick function. */
+	UModularAbilitySubsystem* Target = nullptr;
+
+	//~ Begin FTickFunction Interface
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+	//~ End FTickFunction Interface
+};
+
+template<>
+struct TStructOpsTypeTraits<FModularAbilityInputTickFunction> : public TStructOpsTypeTraitsBase2<FModularAbilityInputTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
 /**
  * Global subsystem for modular gameplay abilities.
  * Manages granting and removing abilities from actors.
@@ -54,6 +83,8 @@ public:
 
 	//~ Begin UWorldSubsystem Interface
 	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
 	//~ End UWorldSubsystem Interface
 
 	static UModularAbilitySubsystem* Get(const UObject* WorldContextObject);
@@ -86,10 +117,29 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Ability|Global")
 	void RemoveEffectFromAll(TSubclassOf<UGameplayEffect> Effect);
 
+	/** Returns true if the ability input of all registered ability systems is processed in one batch by this subsystem. */
+	bool IsBatchingAbilityInput() const { return bBatchAbilityInput; }
+
+	/**
+	 * Enables or disables batched ability input processing.
+	 * While enabled, calls to UModularAbilitySystemComponent::ProcessAbilityInput are ignored,
+	 * and the input of all registered ability systems is processed once per frame in BatchedAbilityInputTickGroup instead.
+	 */
+	void SetBatchAbilityInput(bool bEnabled);
+
+	/** Processes the pending ability input of all registered ability systems. */
+	virtual void ProcessBatchedAbilityInput(float DeltaTime);
+
 protected:
 	/** Gets the list of all registered ability system components. */
 	const TArray<TObjectPtr<UModularAbilitySystemComponent>>& GetRegisteredAbilitySystems() const { return RegisteredAbilitySystems; }
 
+	/** Makes the batched input tick wait for the local player controller of the given ability system, which dispatches its input. */
+	void AddAbilityInputPrerequisite(UModularAbilitySystemComponent* AbilitySystem);
+
+	/** Removes the prerequisite added for the given ability system, unless another registered ability system still shares its controller. */
+	void RemoveAbilityInputPrerequisite(UModularAbilitySystemComponent* AbilitySystem);
+
 private:
 	/** List of all globally applied abilities. */
 	UPROPERTY()
@@ -102,4 +152,27 @@ private:
 	/** List of all registered ability system components. */
 	UPROPERTY()
 	TArray<TObjectPtr<UModularAbilitySystemComponent>> RegisteredAbilitySystems;
+
+	/**
+	 * If true, the ability input of all registered ability systems is processed in one pass by this subsystem,
+	 * instead of each pawn or controller processing the input of its own ability system.
+	 * Ability systems only register once their avatar is a pawn, see UModularAbilitySystemComponent::InitAbilityActorInfo.
+	 * Ability systems with any other avatar never register, so they keep processing their own input.
+	 */
+	UPROPERTY(Config)
+	bool bBatchAbilityInput = false;
+
+	/**
+	 * The tick group in which batched ability input is processed.
+	 * The local player controllers of registered ability systems are prerequisites of the batch, so input dispatched in their tick
+	 * is processed in the same frame. Don't pick a group before the one the player controllers tick in.
+	 */
+	UPROPERTY(Config)
+	TEnumAsByte<ETickingGroup> BatchedAbilityInputTickGroup = TG_PrePhysics;
+
+	/** Tick function used to process batched ability input. */
+	FModularAbilityInputTickFunction AbilityInputTickFunction;
+
+	/** Scratch copy of the registered ability systems, as processing input may register or unregister ability systems. */
+	TArray<TObjectPtr<UModularAbilitySystemComponent>> BatchedAbilitySystems;
 };
@@ -4,12 +4,154 @@
 
 #include "CoreMinimal.h"
 #include "AbilitySystemComponent.h"
+#include "ModularAbilitySystemSnapshot.h"
 #include "Abilities/ModularGameplayAbilityTypes.h"
+#include "Cooldowns/ModularAbilityCharges.h"
+#include "Cooldowns/ModularCooldownLedger.h"
+#include "Misc/ScopeRWLock.h"
 
 #include "ModularAbilitySystemComponent.generated.h"
 
 class UModularAbilityTagRelationshipMapping;
 class UModularGameplayAbility;
+class UModularAbilityInputRouter;
+
+/** Entry of the input lookup tables, binding an ability spec to an input. */
+struct FModularAbilityInputBinding
+{
+	FModularAbilityInputBinding() = default;
+	FModularAbilityInputBinding(const FGameplayAbilitySpecHandle InHandle, const int32 InSlot, const bool bInReceivesInput)
+		: Handle(InHandle)
+		, Slot(InSlot)
+		, bReceivesInput(bInReceivesInput)
+	{
+	}
+
+	/** The bound ability spec. */
+	FGameplayAbilitySpecHandle Handle;
+
+	/** The stable slot of the bound ability spec. */
+	int32 Slot = INDEX_NONE;
+
+	/** Whether the ability is allowed to be activated by input. Resolved from the ability CDO once it gets bound. */
+	bool bReceivesInput = false;
+};
+
+/** Input keys an ability spec is currently bound to in the input lookup tables. */
+struct FModularAbilitySpecInputKeys
+{
+	/** Input tags the spec is bound to. */
+	FGameplayTagContainer InputTags;
+
+	/** Input id the spec is bound to. */
+	int32 InputID = INDEX_NONE;
+};
+
+/** Input press that failed to activate its ability and is retried for a short time. */
+struct FModularBufferedAbilityInput
+{
+	FModularBufferedAbilityInput() = default;
+	FModularBufferedAbilityInput(const FGameplayAbilitySpecHandle InHandle, const double InPressTime)
+		: Handle(InHandle)
+		, PressTime(InPressTime)
+	{
+	}
+
+	/** The ability spec that was pressed. */
+	FGameplayAbilitySpecHandle Handle;
+
+	/** World time at which the input was pressed. */
+	double PressTime = 0.0;
+};
+
+/** Replicated input event of an active ability, sent to the server bundled with all other input events of the same frame. */
+USTRUCT()
+struct FModularReplicatedInputEvent
+{
+	GENERATED_BODY()
+
+	FModularReplicatedInputEvent() = default;
+	FModularReplicatedInputEvent(
+		const FGameplayAbilitySpecHandle InHandle,
+		const FPredictionKey& InOriginalPredictionKey,
+		const FPredictionKey& InCurrentPredictionKey,
+		const bool bInPressed)
+		: Handle(InHandle)
+		, OriginalPredictionKey(InOriginalPredictionKey)
+		, CurrentPredictionKey(InCurrentPredictionKey)
+		, bPressed(bInPressed)
+	{
+	}
+
+	/** The ability spec the input event belongs to. */
+	UPROPERTY()
+	FGameplayAbilitySpecHandle Handle;
+
+	/** The activation prediction key of the ability instance. */
+	UPROPERTY()
+	FPredictionKey OriginalPredictionKey;
+
+	/** The prediction key the input event was generated in. */
+	UPROPERTY()
+	FPredictionKey CurrentPredictionKey;
+
+	/** Whether the input was pressed or released. */
+	UPROPERTY()
+	bool bPressed = false;
+};
+
+/** Running ability instance of an activation group. */
+struct FModularActivationGroupEntry
+{
+	FModularActivationGroupEntry() = default;
+	FModularActivationGroupEntry(UModularGameplayAbility* InAbility, const FGameplayAbilitySpecHandle InHandle)
+		: Ability(InAbility)
+		, Handle(InHandle)
+	{
+	}
+
+	/** The running ability instance, or the CDO for non-instanced abilities. */
+	TWeakObjectPtr<UModularGameplayAbility> Ability;
+
+	/** The spec the ability is running for. */
+	FGameplayAbilitySpecHandle Handle;
+};
+
+/** Cached cooldown of an ability spec, see UModularAbilitySystemComponent::GetCooldownRemaining. */
+struct FModularAbilityCooldownCacheEntry
+{
+	/** World time at which the cooldown started. */
+	double StartTime = 0.0;
+
+	/** Total duration of the cooldown. Zero if the spec wasn't on cooldown. */
+	float Duration = 0.f;
+
+	/** Cooldown tags of the spec. Only changes of these tags outdate the entry. */
+	FGameplayTagContainer CooldownTags;
+
+	/** Whether the entry needs to be re-evaluated on its next query. */
+	bool bOutdated = true;
+};
+
+/** Attribute watched because the costs of granted abilities depend on it, see UModularAbilitySystemComponent::WatchAbilityCostAttributes. */
+struct FModularWatchedCostAttribute
+{
+	/** Binding to the value change delegate of the attribute. */
+	FDelegateHandle DelegateHandle;
+
+	/** Number of granted ability specs whose cost depends on the attribute. */
+	int32 NumSpecs = 0;
+};
+
+/** Activation required and blocked tags of an ability, expanded by the tag relationship mapping. */
+struct FModularAbilityActivationTagRequirements
+{
+	/** Tags the owner must have for the ability to activate. */
+	FGameplayTagContainer RequiredTags;
+
+	/** Tags that block the ability from activating. */
+	FGameplayTagContainer BlockedTags;
+};
 
 /**
  * Extended version of the UAbilitySystemComponent
@@ -18,11 +160,15 @@ UCLASS()
 class MODULARGAMEPLAYABILITIES_API UModularAbilitySystemComponent : public UAbilitySystemComponent
 {
 	GENERATED_BODY()
+	friend class UModularAbilitySubsystem;
+	friend struct FModularCooldownEntry;
+	friend struct FModularAbilityChargeEntry;
 
 public:
 	UModularAbilitySystemComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	//~ Begin UAbilitySystemComponent Interface
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	//~ End UAbilitySystemComponent Interface
 
@@ -37,9 +183,25 @@ public:
 	void AbilityInputIdPressed(int32 InputId);
 	void AbilityInputIdReleased(int32 InputId);
 
+	/**
+	 * Processes the pending ability input.
+	 * Does nothing while the UModularAbilitySubsystem is batching the ability input, as it will be processed by the subsystem instead.
+	 */
 	void ProcessAbilityInput(float DeltaTime, bool bGamePaused);
 	void ClearAbilityInput();
 
+	/** Returns true if there is any pressed, held or released ability input waiting to be processed. */
+	bool HasPendingAbilityInput() const;
+
+	/** Returns true if the ability input of this component is processed in one batch by the UModularAbilitySubsystem. */
+	bool IsAbilityInputBatched() const { return bAbilityInputBatched; }
+
+	/**
+	 * Rebinds the given spec in the input lookup tables.
+	 * Must be called whenever the dynamic tags or the input id of an already granted spec are changed on the server.
+	 */
+	void RefreshAbilitySpecInputBinding(const FGameplayAbilitySpec& Spec);
+
 	/** Whether we currently allow processing ability input. */
 	virtual bool IsAbilityInputAllowed() const { return true; }
 
@@ -50,6 +212,9 @@ public:
 	/** Tries to activate all passive abilities on spawn. */
 	void TryActivateAbilitiesOnSpawn();
 
+	/** Returns the router that shares enhanced input action bindings between all ability tasks of this component. Created on first use. */
+	UModularAbilityInputRouter* GetInputRouter();
+
 	/** Gets the ability target data associated with the given ability handle and activation info. */
 	virtual void GetAbilityTargetData(const FGameplayAbilitySpecHandle AbilityHandle, const FGameplayAbilityActivationInfo& ActivationInfo, FGameplayAbilityTargetDataHandle& OutTargetDataHandle);
 
@@ -60,11 +225,17 @@ public:
 	/** Returns true if the specified activation group is blocked. */
 	bool IsActivationGroupBlocked(EGameplayAbilityActivationGroup::Type Group) const;
 
-	/** Adds the ability to the specified activation group count. */
-	void AddAbilityToActivationGroup(EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* Ability);
+	/**
+	 * Adds the ability to the specified activation group.
+	 * @param Handle The spec the ability runs for. Resolved from the ability instance if not set.
+	 */
+	void AddAbilityToActivationGroup(EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle = FGameplayAbilitySpecHandle());
 
-	/** Removes the ability from the specified activation group count. */
-	void RemoveAbilityFromActivationGroup(EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* Ability);
+	/**
+	 * Removes the ability from the specified activation group.
+	 * @param Handle The spec the ability runs for. Resolved from the ability instance if not set.
+	 */
+	void RemoveAbilityFromActivationGroup(EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* Ability, FGameplayAbilitySpecHandle Handle = FGameplayAbilitySpecHandle());
 
 	/** Cancels all abilities in the specified activation group. */
 	void CancelActivationGroupAbilities(EGameplayAbilityActivationGroup::Type Group, UModularGameplayAbility* AbilityToIgnore, bool bReplicateCancelAbilities = true);
@@ -80,6 +251,12 @@ public:
 	/** Looks at ability tags and gathers additional required and blocked tags. */
 	virtual void GetAdditionalActivationTagRequirements(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer& OutActivationRequired, FGameplayTagContainer& OutActivationBlocked) const;
 
+	/**
+	 * Returns the activation required and blocked tags of the ability, expanded by GetAdditionalActivationTagRequirements.
+	 * Cached per ability class until the tag relationship mapping changes.
+	 */
+	const FModularAbilityActivationTagRequirements& GetActivationTagRequirements(const UModularGameplayAbility* Ability) const;
+
 	/** Handles the ability failed to activate. */
 	virtual void HandleAbilityFailed(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason);
 
@@ -87,6 +264,22 @@ public:
 	UFUNCTION(Client, Unreliable)
 	void ClientNotifyAbilityFailed(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason);
 
+	/**
+	 * Queues an input event of an active ability to be sent to the server.
+	 * All events queued until the next flush are sent in a single RPC, instead of one ServerSetReplicatedEvent per event.
+	 * The queue is flushed at the end of ProcessAbilityInput, on the next tick at the latest, and before every ability RPC this component
+	 * or UModularGameplayAbility sends (activation, end, cancel, target data, confirm and cancel input), so those can't overtake it.
+	 * Call FlushReplicatedInputEvents before sending any other server RPC that depends on the queued events.
+	 */
+	void QueueReplicatedInputEvent(const FGameplayAbilitySpecHandle Handle, const FPredictionKey& OriginalPredictionKey, const FPredictionKey& CurrentPredictionKey, bool bPressed);
+
+	/** Sends all queued input events to the server. */
+	void FlushReplicatedInputEvents();
+
+	/** Invokes the bundled input events on the server. */
+	UFUNCTION(Server, Reliable)
+	void ServerSetReplicatedInputEvents(const TArray<FModularReplicatedInputEvent>& InputEvents);
+
 	/** Returns all tracked actors for a specified ability. */
 	UFUNCTION(BlueprintCallable, Category = Tracking)
 	FGameplayAbilitySpecHandle GetTrackedActorsForAbility(const UGameplayAbility* Ability, TArray<FAbilityTrackedActorEntry>& OutTrackedActors) const;
@@ -120,6 +313,12 @@ public:
 	virtual void AbilitySpecInputPressed(FGameplayAbilitySpec& Spec) override;
 	virtual void AbilitySpecInputReleased(FGameplayAbilitySpec& Spec) override;
 
+	virtual void CallServerTryActivateAbility(FGameplayAbilitySpecHandle AbilityToActivate, bool InputPressed, FPredictionKey PredictionKey) override;
+	virtual void CallServerEndAbility(FGameplayAbilitySpecHandle AbilityToEnd, FGameplayAbilityActivationInfo ActivationInfo, FPredictionKey PredictionKey) override;
+	virtual void CallServerSetReplicatedTargetData(FGameplayAbilitySpecHandle AbilityHandle, FPredictionKey AbilityOriginalPredictionKey, const FGameplayAbilityTargetDataHandle& ReplicatedTargetDataHandle, FGameplayTag ApplicationTag, FPredictionKey CurrentPredictionKey) override;
+	virtual void LocalInputConfirm() override;
+	virtual void LocalInputCancel() override;
+
 	virtual void NotifyAbilityActivated(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability) override;
 	virtual void NotifyAbilityFailed(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason) override;
 	virtual void NotifyAbilityEnded(FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled) override;
@@ -128,22 +327,419 @@ public:
 
 	virtual void ApplyAbilityBlockAndCancelTags(const FGameplayTagContainer& AbilityTags, UGameplayAbility* RequestingAbility, bool bEnableBlockTags, const FGameplayTagContainer& BlockTags, bool bExecuteCancelTags, const FGameplayTagContainer& CancelTags) override;
 
+	virtual void BlockAbilitiesWithTags(const FGameplayTagContainer& Tags) override;
+	virtual void UnBlockAbilitiesWithTags(const FGameplayTagContainer& Tags) override;
+
 	virtual void OnGiveAbility(FGameplayAbilitySpec& AbilitySpec) override;
 	virtual void OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+	virtual void OnRep_ActivateAbilities() override;
 	//~ End UAbilitySystemComponent Interface
 
+	/**
+	 * Returns the handles of all granted abilities that can currently be activated, evaluating tags, activation group, cooldown and cost.
+	 * The result is cached and only re-evaluated after something that affects activation changed, so polling it every frame is cheap.
+	 */
+	const TArray<FGameplayAbilitySpecHandle>& GetCurrentlyActivatableAbilities() const;
+
+	/** Returns true if the ability spec can currently be activated. Uses the same cache as GetCurrentlyActivatableAbilities. */
+	bool IsAbilitySpecActivatable(const FGameplayAbilitySpecHandle& Handle) const;
+
+	/**
+	 * Marks the cached activatable abilities as outdated.
+	 * Only needs to be called by game code whose activation conditions depend on state the component doesn't track, e.g. a custom CanActivateAbility.
+	 */
+	void MarkActivatableAbilitiesDirty();
+
+	/**
+	 * Returns the last published state snapshot, or nullptr if none was published yet.
+	 * Safe to call from any thread. Worker jobs should fetch it once and keep the pointer for the duration of the job.
+	 */
+	FModularAbilitySystemSnapshotPtr GetStateSnapshot() const;
+
+	/** Enables or disables publishing the state snapshot. */
+	void SetPublishStateSnapshot(bool bEnabled);
+
+	/** Returns true if the component publishes a state snapshot whenever its state changes. */
+	bool IsPublishingStateSnapshot() const { return bPublishStateSnapshot; }
+
+	// ----------------------------------------------------------------------------------------------------------------
+	//	Cooldown Ledger
+	// ----------------------------------------------------------------------------------------------------------------
+
+	/** Returns true if the cooldowns of modular abilities are tracked in the cooldown ledger instead of by cooldown gameplay effects. */
+	bool IsUsingCooldownLedger() const { return bUseCooldownLedger; }
+
+	/**
+	 * Puts the given tags on cooldown in the cooldown ledger.
+	 * On the server the ledger replicates to the owner. Clients track the cooldown locally until the server's arrives.
+	 * @param PredictionKey If valid, a predicted cooldown is removed again when the server rejects the key.
+	 */
+	void ApplyLedgerCooldown(const FGameplayTagContainer& CooldownTags, float Duration, FPredictionKey PredictionKey = FPredictionKey());
+
+	/** Returns true if any of the given tags, or one of their children, is on cooldown in the cooldown ledger. */
+	bool IsOnLedgerCooldown(const FGameplayTagContainer& CooldownTags) const;
+
+	/**
+	 * Gets the longest remaining cooldown of the given tags in the cooldown ledger.
+	 * @return False if none of the tags is on cooldown.
+	 */
+	bool GetLedgerCooldownTimeRemaining(const FGameplayTagContainer& CooldownTags, float& OutTimeRemaining, float& OutDuration) const;
+
+	/** Returns the current time of the cooldown ledger, which is the server world time. */
+	double GetCooldownLedgerTime() const;
+
+	/**
+	 * Returns the remaining cooldown of the given spec, and optionally its total duration.
+	 * Served from a per-spec cache that is written when the spec applies its cooldown, and only re-evaluated after cooldowns changed otherwise.
+	 * Meant for UI polling many ability slots every frame.
+	 */
+	float GetCooldownRemaining(const FGameplayAbilitySpecHandle& Handle, float* OutDuration = nullptr) const;
+
+	/** Records that the given spec just went on cooldown. Called by modular abilities whenever they apply their cooldown. */
+	void RecordAbilityCooldown(const FGameplayAbilitySpecHandle& Handle, float Duration, const FGameplayTagContainer& CooldownTags);
+
+	/** Marks the cached cooldowns of all specs that use any of the given cooldown tags as outdated, so they are re-evaluated on their next query. */
+	void InvalidateCooldownCache(TConstArrayView<FGameplayTag> ChangedTags);
+
+	/** Marks the cached cooldown of a single spec as outdated. */
+	void InvalidateCooldownCache(const FGameplayAbilitySpecHandle& Handle);
+
+	// ----------------------------------------------------------------------------------------------------------------
+	//	Cooldown Groups
+	// ----------------------------------------------------------------------------------------------------------------
+
+	/**
+	 * Puts the given cooldown group on cooldown, which puts all abilities referencing the group on cooldown.
+	 * The group is stored as a single entry in the cooldown ledger, independent of whether the ledger is used for other cooldowns.
+	 * @param PredictionKey If valid, a predicted group cooldown is removed again when the server rejects the key.
+	 */
+	void ApplyCooldownGroup(const FGameplayTag& GroupTag, float Duration, FPredictionKey PredictionKey = FPredictionKey());
+
+	/** Returns true if the given cooldown group is on cooldown. */
+	bool IsCooldownGroupActive(const FGameplayTag& GroupTag) const;
+
+	/**
+	 * Gets the remaining cooldown of the given cooldown group.
+	 * @return False if the group isn't on cooldown.
+	 */
+	bool GetCooldownGroupTimeRemaining(const FGameplayTag& GroupTag, float& OutTimeRemaining, float& OutDuration) const;
+
+	/** Returns the granted ability specs that share the given cooldown group. */
+	TConstArrayView<FGameplayAbilitySpecHandle> GetCooldownGroupMembers(const FGameplayTag& GroupTag) const;
+
+	/** Broadcast when a cooldown group went on cooldown, or its predicted cooldown got rejected. Passes the group tag, the remaining time and the duration. */
+	DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnCooldownGroupChanged, const FGameplayTag&, float, float);
+	FOnCooldownGroupChanged OnCooldownGroupChanged;
+
+	// ----------------------------------------------------------------------------------------------------------------
+	//	Ability Charges
+	// ----------------------------------------------------------------------------------------------------------------
+
+	/** Returns the charge state of the given spec, or nullptr if it never consumed a charge. Prefers the locally predicted state. */
+	const FModularAbilityChargeEntry* FindAbilityCharges(const FGameplayAbilitySpecHandle& Handle) const;
+
+	/** Returns the number of charges the given spec currently has, or MaxCharges if it never consumed a charge. */
+	int32 GetAbilityCharges(const FGameplayAbilitySpecHandle& Handle, int32 MaxCharges) const;
+
+	/**
+	 * Consumes a charge of the given spec. Charges recharge one after another, each taking RechargeDuration.
+	 * On the server the charge state replicates to the owner. Clients track it locally until the server's arrives.
+	 * @param PredictionKey If valid, a predicted charge is given back when the server rejects the key.
+	 */
+	void ConsumeAbilityCharge(const FGameplayAbilitySpecHandle& Handle, int32 MaxCharges, float RechargeDuration, FPredictionKey PredictionKey = FPredictionKey());
+
 protected:
+	//~ Begin UAbilitySystemComponent Interface
+	virtual void OnTagUpdated(const FGameplayTag& Tag, bool TagExists) override;
+	//~ End UAbilitySystemComponent Interface
+
+	/** Processes the pending ability input, regardless of whether the input is batched. */
+	void ProcessAbilityInputInternal(float DeltaTime, bool bGamePaused);
+
+	/** Buffers an input press that failed to activate its ability, so it can be retried once the blocking ability ends. */
+	void BufferAbilityInput(const FGameplayAbilitySpecHandle& Handle);
+
+	/** Schedules a retry of the buffered ability input for the next tick. */
+	void ScheduleBufferedAbilityInputRetry();
+
+	/** Tries to activate the abilities of all buffered input presses that haven't expired yet. */
+	void RetryBufferedAbilityInput();
+
+	/** Adds the spec to the input lookup tables. */
+	void AddAbilitySpecToInputBindings(const FGameplayAbilitySpec& Spec);
+
+	/** Removes the spec from the input lookup tables. */
+	void RemoveAbilitySpecFromInputBindings(const FGameplayAbilitySpecHandle& Handle);
+
+	/** Clears and rebuilds the input lookup tables from all activatable abilities. */
+	void RebuildAbilityInputBindings();
+
+	/** Assigns a stable slot to the given ability spec, reusing slots of removed specs. */
+	int32 AllocateAbilitySpecSlot(const FGameplayAbilitySpecHandle& Handle);
+
+	/** Frees the slot of the given ability spec and clears any input state stored for it. */
+	void ReleaseAbilitySpecSlot(const FGameplayAbilitySpecHandle& Handle);
+
+	/**
+	 * Finds the ability spec of the given handle using a cached handle to index map instead of a linear search.
+	 * Behaves like FindAbilitySpecFromHandle, except that pending adds aren't considered.
+	 *
+	 * Used by every lookup this component owns. The cancel paths don't look up specs at all, they walk the activation groups or
+	 * the active specs directly. TryActivateAbility, CancelAbilityHandle and the base NotifyAbilityEnded still search linearly,
+	 * as FindAbilitySpecFromHandle and those entry points aren't virtual and can't be rerouted without copying the engine's implementation.
+	 */
+	FGameplayAbilitySpec* FindAbilitySpecFromHandleCached(const FGameplayAbilitySpecHandle& Handle) const;
+
+	/** Marks the cached handle to index map as outdated. Called whenever ActivatableAbilities gets mutated. */
+	void InvalidateAbilitySpecIndices() const { bAbilitySpecIndicesDirty = true; }
+
+	/** Rebuilds the cached handle to index map from ActivatableAbilities. */
+	void RebuildAbilitySpecIndices() const;
+
+	/** Indexes the spec under its activation required tags, if it is a passive ability that activates once they are added. */
+	void AddAbilitySpecToRequiredTagWatchers(const FGameplayAbilitySpec& Spec);
+
+	/** Removes the spec from the required tag index. */
+	void RemoveAbilitySpecFromRequiredTagWatchers(const FGameplayAbilitySpecHandle& Handle);
+
+	/** Clears and rebuilds the required tag index from all activatable abilities. */
+	void RebuildRequiredTagWatchers();
+
+	/** Tries to activate the passive abilities that wait for the given tag, if the owner now has all their required tags. */
+	void TryActivateAbilitiesWaitingForTag(const FGameplayTag& Tag);
+
+	/** Re-evaluates which ability specs can currently be activated, if anything changed since they were last evaluated. */
+	void UpdateActivatableSpecs() const;
+
+	/** Re-evaluates which ability specs can currently be activated. */
+	void RebuildActivatableSpecs() const;
+
+	/** Gathers the attributes the cost of the spec's ability depends on. */
+	static void GetAbilityCostAttributes(const FGameplayAbilitySpec& Spec, TArray<FGameplayAttribute>& OutAttributes);
+
+	/** Binds to value changes of the attributes the cost of the spec's ability depends on. */
+	void WatchAbilityCostAttributes(const FGameplayAbilitySpec& Spec);
+
+	/** Unbinds from the cost attributes of the spec's ability that no other granted ability depends on. */
+	void UnwatchAbilityCostAttributes(const FGameplayAbilitySpec& Spec);
+
+	/** Called when an attribute that any granted ability's cost depends on changed. */
+	void OnCostAttributeChanged(const FOnAttributeChangeData& ChangeData);
+
+	/** Schedules publishing a new state snapshot on the next tick. */
+	void ScheduleStateSnapshotPublish();
+
+	/** Captures the current state into a new snapshot and publishes it. */
+	void PublishStateSnapshot();
+
+	/** Called when an attribute captured by the state snapshot changed. */
+	void OnSnapshotAttributeChanged(const FOnAttributeChangeData& ChangeData);
+
+	/** Binds to value changes of the snapshot attributes, if not done yet. */
+	void BindSnapshotAttributes();
+
+	/** Removes the bindings made by BindSnapshotAttributes. */
+	void UnbindSnapshotAttributes();
+
+	/** Puts the given tags on cooldown in the cooldown ledger. See ApplyLedgerCooldown. */
+	void ApplyLedgerCooldownTags(TConstArrayView<FGameplayTag> CooldownTags, float Duration, FPredictionKey PredictionKey);
+
+	/** Removes the predicted cooldowns of an activation the server rejected. */
+	void OnPredictedLedgerCooldownRejected(TArray<FGameplayTag> CooldownTags);
+
+	/** Called when any gameplay effect got removed. Outdates the cached cooldowns if the effect may have been a cooldown. */
+	void OnCooldownEffectRemoved(const FActiveGameplayEffect& Effect);
+
+	/** Adds the spec to the member index of its ability's cooldown group, if it has one. */
+	void AddAbilitySpecToCooldownGroup(const FGameplayAbilitySpec& Spec);
+
+	/** Removes the spec from the cooldown group member index. */
+	void RemoveAbilitySpecFromCooldownGroup(const FGameplayAbilitySpecHandle& Handle);
+
+	/** Clears and rebuilds the cooldown group member index from all activatable abilities. */
+	void RebuildCooldownGroups();
+
+	/** Called on clients when a cooldown of the replicated cooldown ledger was added or changed. */
+	void OnCooldownLedgerEntryReplicated(const FModularCooldownEntry& Entry);
+
+	/** Removes the predicted charge state of an activation the server rejected. */
+	void OnPredictedAbilityChargeRejected(FGameplayAbilitySpecHandle Handle);
+
+	/** Called on clients when the replicated charge state of a spec was added or changed. */
+	void OnAbilityChargesReplicated(const FModularAbilityChargeEntry& Entry);
+
+	/** Schedules a timer for the next cooldown that ends in the cooldown ledger, or the next charge of a spec without charges. */
+	void ScheduleCooldownExpiry();
+
+	/** Called when a cooldown of the cooldown ledger ended or a depleted spec got a charge back. */
+	void OnCooldownExpired();
+
+	/** Returns the stable slot of the given ability spec, or INDEX_NONE if it has none. */
+	int32 GetAbilitySpecSlot(const FGameplayAbilitySpecHandle& Handle) const
+	{
+		const int32* Slot = AbilitySpecSlots.Find(Handle);
+		return Slot ? *Slot : INDEX_NONE;
+	}
+
+protected:
+	/** If true, an immutable snapshot of the state is published whenever it changed, at most once per frame. See GetStateSnapshot. */
+	UPROPERTY(EditDefaultsOnly, Category = Snapshot)
+	uint8 bPublishStateSnapshot : 1;
+
+	/** Attributes whose values are captured in the state snapshot. */
+	UPROPERTY(EditDefaultsOnly, Category = Snapshot, meta = (EditCondition = "bPublishStateSnapshot"))
+	TArray<FGameplayAttribute> SnapshotAttributes;
+
+	/** The last published state snapshot. Guarded by StateSnapshotLock, as it may be read from any thread. */
+	FModularAbilitySystemSnapshotPtr StateSnapshot;
+
+	/** Guards swapping StateSnapshot. */
+	mutable FRWLock StateSnapshotLock;
+
+	/** Version of the last published state snapshot. */
+	uint32 StateSnapshotVersion = 0;
+
+	/**
+	 * If true, modular abilities put their cooldown tags on cooldown in a flat, replicated table instead of applying a cooldown gameplay effect.
+	 * Cheaper to apply, replicate and query, but other gameplay effects can't react to these cooldowns.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = Cooldowns)
+	uint8 bUseCooldownLedger : 1;
+
+	/** Cooldowns applied by the server. Only replicated to the owner. */
+	UPROPERTY(Replicated)
+	FModularCooldownLedger CooldownLedger;
+
+	/** Cooldowns predicted by this client that the server didn't replicate yet. */
+	FModularCooldownLedger PredictedCooldownLedger;
+
+	/** Cached cooldown of each ability spec, see GetCooldownRemaining. */
+	mutable TMap<FGameplayAbilitySpecHandle, FModularAbilityCooldownCacheEntry> CooldownCache;
+
+	/** Cooldown tags of all specs in the cooldown cache. Quick filter before looking at the single entries. */
+	mutable FGameplayTagContainer CooldownCacheTags;
+
+	/** Granted ability specs of each cooldown group. */
+	TMap<FGameplayTag, TArray<FGameplayAbilitySpecHandle, TInlineAllocator<4>>> CooldownGroupMembers;
+
+	/** Cooldown group each spec is indexed under. Used to unindex a spec without scanning the whole table. */
+	TMap<FGameplayAbilitySpecHandle, FGameplayTag> SpecCooldownGroups;
+
+	/** Charge states of the specs that consumed a charge. Only replicated to the owner. */
+	UPROPERTY(Replicated)
+	FModularAbilityChargeList AbilityCharges;
+
+	/** Charge states predicted by this client that the server didn't catch up with yet. Covers every consume still in flight. */
+	TMap<FGameplayAbilitySpecHandle, FModularAbilityChargeEntry> PredictedAbilityCharges;
+
+	/** Timer for the next cooldown that ends in either ledger, or the next charge of a depleted spec. */
+	FTimerHandle CooldownExpiryTimer;
+
 	/** If set, this table is used to look up tag relationships for abilities. */
 	UPROPERTY()
 	TObjectPtr<UModularAbilityTagRelationshipMapping> TagRelationshipMapping;
 
-	TArray<FGameplayAbilitySpecHandle> InputPressedHandles;		// Handles to abilities that input activated this frame
-	TArray<FGameplayAbilitySpecHandle> InputReleasedHandles;	// Handles to abilities that input released this frame
-	TArray<FGameplayAbilitySpecHandle> InputHeldHandles;		// Handles to abilities that are currently input held
+	/** Expanded activation tag requirements of each ability class, see GetActivationTagRequirements. */
+	mutable TMap<TObjectKey<UClass>, FModularAbilityActivationTagRequirements> ActivationTagRequirementsCache;
+
+	/** Compile serial of the tag relationship mapping the requirements were cached with. */
+	mutable uint32 ActivationTagRequirementsSerial = 0;
+
+	/** Slots of the ability specs that can currently be activated. Only valid while bActivatableSpecsDirty is false. */
+	mutable TBitArray<> ActivatableSpecSlots;
+
+	/** Handles of the ability specs that can currently be activated. Only valid while bActivatableSpecsDirty is false. */
+	mutable TArray<FGameplayAbilitySpecHandle> ActivatableSpecHandles;
+
+	/** Slots of the ability specs whose cost can currently be afforded. Rebuilt along with ActivatableSpecSlots. */
+	mutable TBitArray<> AffordableSpecSlots;
+
+	/**
+	 * Replication key of ActivatableAbilities when ActivatableSpecSlots was last rebuilt.
+	 * MarkAbilitySpecDirty bumps it, so changing the level or dynamic tags of a spec outdates the cache as well.
+	 */
+	mutable int32 ActivatableSpecsReplicationKey = INDEX_NONE;
+
+	/** Passive ability specs indexed by each of their activation required tags, see UModularGameplayAbility::GetPassiveActivationWatchedTags. */
+	TMap<FGameplayTag, TArray<FGameplayAbilitySpecHandle, TInlineAllocator<2>>> RequiredTagWatchers;
+
+	/** Required tags each spec is currently indexed under. Used to unindex a spec without scanning the whole table. */
+	TMap<FGameplayAbilitySpecHandle, FGameplayTagContainer> SpecRequiredTagKeys;
+
+	/** Attributes whose value changes are watched because granted abilities' costs depend on them. */
+	TMap<FGameplayAttribute, FModularWatchedCostAttribute> WatchedCostAttributes;
+
+	/** Value change bindings of the snapshot attributes, see BindSnapshotAttributes. */
+	TArray<TPair<FGameplayAttribute, FDelegateHandle>> SnapshotAttributeBindings;
+
+	/** Router for enhanced input action events, see GetInputRouter. */
+	UPROPERTY(Transient)
+	TObjectPtr<UModularAbilityInputRouter> InputRouter;
+
+	TBitArray<> InputPressedSlots;		// Slots of abilities that input activated this frame
+	TBitArray<> InputReleasedSlots;		// Slots of abilities that input released this frame
+	TBitArray<> InputHeldSlots;			// Slots of abilities that are currently input held
+
+	/** Stable slot of each granted ability spec. Slots stay the same for the lifetime of the spec. */
+	TMap<FGameplayAbilitySpecHandle, int32> AbilitySpecSlots;
+
+	/** Ability spec handle occupying each slot. Invalid for free slots. */
+	TArray<FGameplayAbilitySpecHandle> AbilitySpecSlotHandles;
+
+	/** Slots that were freed by removed specs and can be reused. */
+	TArray<int32> FreeAbilitySpecSlots;
+
+	/** Index of each ability spec in ActivatableAbilities.Items. Only valid while bAbilitySpecIndicesDirty is false. */
+	mutable TMap<FGameplayAbilitySpecHandle, int32> AbilitySpecIndices;
+
+	/** Scratch buffer for the abilities ProcessAbilityInput tries to activate. Kept around to avoid reallocating every frame. */
+	TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>> HandlesToActivate;
+
+	/** Input presses that failed to activate their ability, oldest first. */
+	TArray<FModularBufferedAbilityInput, TInlineAllocator<4>> BufferedAbilityInputs;
+
+	/** Input events waiting to be sent to the server. */
+	TArray<FModularReplicatedInputEvent> PendingReplicatedInputEvents;
+
+	/** Ability specs bound to each input tag, so input events don't need to scan all activatable abilities. */
+	TMap<FGameplayTag, TArray<FModularAbilityInputBinding>> InputTagBindings;
+
+	/** Ability specs bound to each input id, indexed by the input id. Only used with the alter ability input. */
+	TArray<TArray<FModularAbilityInputBinding>> InputIdBindings;
+
+	/** Input keys each ability spec is currently bound to. Used to unbind a spec without scanning the whole table. */
+	TMap<FGameplayAbilitySpecHandle, FModularAbilitySpecInputKeys> SpecInputKeys;
+
+	/** Cached UModularGameplayAbilitiesSettings::bEnableAlterAbilityInput, resolved once when the component is created. */
+	uint8 bUseAlterAbilityInput : 1;
+
+	/** Whether the ability input is processed in one batch by the UModularAbilitySubsystem. */
+	uint8 bAbilityInputBatched : 1;
+
+	/** Whether a retry of the buffered ability input is scheduled for the next tick. */
+	uint8 bBufferedAbilityInputRetryPending : 1;
+
+	/** Whether a flush of the pending input events is scheduled for the next tick. */
+	uint8 bReplicatedInputFlushPending : 1;
+
+	/** Whether ActivatableAbilities was mutated since AbilitySpecIndices was last rebuilt. */
+	mutable uint8 bAbilitySpecIndicesDirty : 1;
+
+	/** Whether anything that affects ability activation changed since ActivatableSpecSlots was last rebuilt. */
+	mutable uint8 bActivatableSpecsDirty : 1;
+
+	/** Whether publishing a state snapshot is scheduled for the next tick. */
+	uint8 bStateSnapshotPublishPending : 1;
+
+	/** Whether the value changes of the snapshot attributes are watched. */
+	uint8 bSnapshotAttributesBound : 1;
 
 	/** Cached number of abilities running in each activation group. */
 	int32 ActivationGroupCounts[static_cast<uint8>(EGameplayAbilityActivationGroup::MAX)];
 
+	/** Abilities running in each activation group, so a group can be canceled without scanning all activatable abilities. */
+	TArray<FModularActivationGroupEntry, TInlineAllocator<2>> ActivationGroupAbilities[static_cast<uint8>(EGameplayAbilityActivationGroup::MAX)];
+
 public:
 	/** Currently tracked actors for each tag. */
 	TMap<FGameplayTag, TArray<FAbilityTrackedActorEntry>> TagTrackedActors;
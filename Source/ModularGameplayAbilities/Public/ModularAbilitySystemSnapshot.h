@@ -0,0 +1,99 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AttributeSet.h"
+#include "GameplayAbilitySpecHandle.h"
+#include "GameplayTagContainer.h"
+#include "Abilities/ModularGameplayAbilityTypes.h"
+#include "UObject/ObjectKey.h"
+
+class UGameplayAbility;
+
+/** State of a single ability spec, captured in a FModularAbilitySystemSnapshot. */
+struct FModularAbilitySpecSnapshot
+{
+	/** The ability spec this state belongs to. */
+	FGameplayAbilitySpecHandle Handle;
+
+	/** Class of the granted ability. */
+	TObjectKey<UClass> AbilityClass;
+
+	/** Level of the ability spec. */
+	int32 Level = 1;
+
+	/** World time at which the cooldown of the ability ends, or zero if it isn't on cooldown. */
+	double CooldownEndTime = 0.0;
+
+	/** Total duration of the current cooldown. */
+	float CooldownDuration = 0.f;
+
+	/** Whether the ability is currently active. */
+	uint8 bActive : 1 = false;
+
+	/** Whether the ability is currently on cooldown. */
+	uint8 bOnCooldown : 1 = false;
+
+	/** Whether the owner can currently afford the cost of the ability. */
+	uint8 bCostAffordable : 1 = false;
+
+	/** Whether the ability could be activated, evaluating tags, activation group, cooldown and cost. */
+	uint8 bActivatable : 1 = false;
+
+	/** Returns the remaining cooldown at the given world time. */
+	float GetCooldownRemaining(double WorldTime) const
+	{
+		return bOnCooldown ? static_cast<float>(FMath::Max(CooldownEndTime - WorldTime, 0.0)) : 0.f;
+	}
+};
+
+/**
+ * Immutable copy of the ability relevant state of a UModularAbilitySystemComponent.
+ * Published by the component at most once per frame, and only if anything changed since the last one.
+ * As it is never modified once published, it can be read from any thread without locking.
+ */
+struct MODULARGAMEPLAYABILITIES_API FModularAbilitySystemSnapshot
+{
+	/** Returns the state of the given ability spec, or nullptr if it wasn't granted when the snapshot was taken. */
+	const FModularAbilitySpecSnapshot* FindSpec(const FGameplayAbilitySpecHandle& Handle) const;
+
+	/** Returns the state of the first ability spec of the given class, or nullptr if none was granted. */
+	const FModularAbilitySpecSnapshot* FindSpecByClass(const UClass* AbilityClass) const;
+
+	/** Returns true if the given ability spec could be activated when the snapshot was taken. */
+	bool CanActivateAbility(const FGameplayAbilitySpecHandle& Handle) const
+	{
+		const FModularAbilitySpecSnapshot* Spec = FindSpec(Handle);
+		return Spec && Spec->bActivatable;
+	}
+
+	/** Returns the captured value of the given attribute, or false if it wasn't captured. */
+	bool GetAttributeValue(const FGameplayAttribute& Attribute, float& OutValue) const;
+
+	/** Returns the number of abilities that were running in the given activation group. */
+	int32 GetActivationGroupCount(EGameplayAbilityActivationGroup::Type Group) const
+	{
+		return ActivationGroupCounts[static_cast<uint8>(Group)];
+	}
+
+	/** Number that increases with every snapshot published by the same component. */
+	uint32 Version = 0;
+
+	/** World time at which the snapshot was taken. */
+	double WorldTime = 0.0;
+
+	/** The owned gameplay tags. */
+	FGameplayTagContainer OwnedTags;
+
+	/** Number of abilities running in each activation group. */
+	int32 ActivationGroupCounts[static_cast<uint8>(EGameplayAbilityActivationGroup::MAX)] = {};
+
+	/** State of each granted ability spec. */
+	TArray<FModularAbilitySpecSnapshot> Specs;
+
+	/** Values of the attributes the component was configured to capture. */
+	TArray<TPair<FGameplayAttribute, float>> AttributeValues;
+};
+
+typedef TSharedPtr<const FModularAbilitySystemSnapshot, ESPMode::ThreadSafe> FModularAbilitySystemSnapshotPtr;
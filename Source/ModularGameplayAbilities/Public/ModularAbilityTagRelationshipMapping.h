@@ -4,9 +4,25 @@
 
 #include "GameplayTagContainer.h"
 #include "Engine/DataAsset.h"
+#include "Misc/ScopeRWLock.h"
+#include "Templates/UniquePtr.h"
 
 #include "ModularAbilityTagRelationshipMapping.generated.h"
 
+/** How a tag relationship mapping resolves the relationships of a set of ability tags it hasn't seen before. */
+UENUM(BlueprintType)
+enum class EModularTagRelationshipEvaluation : uint8
+{
+	/** Walks all relationships and matches the ability tags with the gameplay tag hierarchy. */
+	Linear,
+
+	/**
+	 * Compiles all relationships into bitsets over the gameplay tag net indices, with parent tags pre-expanded.
+	 * Matching then only tests single bits and merges the results word by word.
+	 */
+	Bitmask
+};
+
 /**
  * Struct that defines the relationship between different ability tags.
  */
@@ -41,6 +57,108 @@ public:
 	FGameplayTagContainer ActivationBlockedTags;
 };
 
+/** Tags resolved by a tag relationship mapping for a set of ability tags. */
+struct FModularAbilityTagRelationshipResult
+{
+	/** The other ability tags that will be blocked by the ability. */
+	FGameplayTagContainer TagsToBlock;
+
+	/** The other ability tags that will be canceled by the ability. */
+	FGameplayTagContainer TagsToCancel;
+
+	/** Additional activation-required tags of the ability. */
+	FGameplayTagContainer ActivationRequiredTags;
+
+	/** Additional activation-blocked tags of the ability. */
+	FGameplayTagContainer ActivationBlockedTags;
+};
+
+/** Relationships of a single ability tag, baked into a compiled tag relationship table. */
+USTRUCT()
+struct FModularCompiledTagRelationshipEntry
+{
+	GENERATED_BODY()
+
+public:
+	FModularCompiledTagRelationshipEntry();
+
+	/** The ability tag all relationships of this entry share. */
+	UPROPERTY()
+	FGameplayTag AbilityTag;
+
+	/** Outputs of the relationships that require an exact match, as indices into the container pool. In the order of FModularAbilityTagRelationshipResult. */
+	UPROPERTY()
+	int32 ExactOutputs[4];
+
+	/** Outputs of the relationships that match this tag or any child of it, pre-expanded with the partial relationships of all parent tags. */
+	UPROPERTY()
+	int32 PartialOutputs[4];
+
+	/** Union of the tags to cancel of all relationships of this ability tag, see IsAbilityCancelledByTag. */
+	UPROPERTY()
+	int32 ActionCancelTags = 0;
+};
+
+/**
+ * Tag relationships compiled into one entry per ability tag, with deduplicated output containers.
+ * Baked into mappings when they get cooked, so they don't need to be compiled when loaded.
+ */
+USTRUCT()
+struct FModularCompiledTagRelationshipTable
+{
+	GENERATED_BODY()
+
+public:
+	/** Compiles the given relationships into this table. */
+	void Build(TConstArrayView<FModularAbilityTagRelationship> Relationships);
+
+	/** Rebuilds the lookup of the entries. Must be called after the table was loaded. */
+	void BuildEntryIndices();
+
+	/** Resolves the result for the given ability tags. */
+	void Evaluate(const FGameplayTagContainer& AbilityTags, FModularAbilityTagRelationshipResult& OutResult) const;
+
+	/** Returns the entry of the given ability tag, or nullptr if no relationship uses the tag. */
+	const FModularCompiledTagRelationshipEntry* FindEntry(const FGameplayTag& Tag) const
+	{
+		const int32* EntryIndex = EntryIndices.Find(Tag);
+		return EntryIndex ? &Entries[*EntryIndex] : nullptr;
+	}
+
+	bool IsEmpty() const { return Entries.IsEmpty(); }
+
+	/** Deduplicated containers referenced by the entries. The first one is always empty. */
+	UPROPERTY()
+	TArray<FGameplayTagContainer> ContainerPool;
+
+	/** One entry for each distinct ability tag of the relationships. */
+	UPROPERTY()
+	TArray<FModularCompiledTagRelationshipEntry> Entries;
+
+private:
+	/** Index of the entry of each ability tag. */
+	TMap<FGameplayTag, int32> EntryIndices;
+};
+
+/** Key funcs that treat tag containers with the same tags in a different order as the same key. */
+struct FModularAbilityTagContainerKeyFuncs : TDefaultMapKeyFuncs<FGameplayTagContainer, TUniquePtr<FModularAbilityTagRelationshipResult>, false>
+{
+	static bool Matches(KeyInitType A, KeyInitType B)
+	{
+		return (A.Num() == B.Num()) && A.HasAllExact(B);
+	}
+
+	static uint32 GetKeyHash(KeyInitType Key)
+	{
+		uint32 Hash = 0;
+		for (const FGameplayTag& Tag : Key)
+		{
+			Hash += MurmurFinalize32(GetTypeHash(Tag));
+		}
+		return Hash;
+	}
+};
+
 /**
  * Data asset that maps relationships between gameplay tags and gameplay abilities
  * Such as how a tag may block an ability from being activated or cancel an ability that is already active
@@ -53,6 +171,35 @@ class MODULARGAMEPLAYABILITIES_API UModularAbilityTagRelationshipMapping : publi
 public:
 	UModularAbilityTagRelationshipMapping();
 
+	//~ Begin UObject Interface
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#endif
+	//~ End UObject Interface
+
+	/**
+	 * Creates a transient mapping that includes the relationships of all given mappings, e.g. one per game feature.
+	 * Meant to be created once when the set of mappings changes, so swapping the mapping on an ability system is a pointer swap.
+	 */
+	static UModularAbilityTagRelationshipMapping* CreateMergedMapping(UObject* Outer, TConstArrayView<UModularAbilityTagRelationshipMapping*> Mappings);
+
+	/**
+	 * Drops all memoized results and resolves the results for every ability tag of the relationships up front.
+	 * Called on load and whenever the relationships were modified.
+	 */
+	void CompileRelationships();
+
+	/**
+	 * Returns the memoized result for the given ability tags, resolving it on first use.
+	 * The returned reference stays valid until the relationships get compiled again.
+	 */
+	const FModularAbilityTagRelationshipResult& GetRelationshipResult(const FGameplayTagContainer& AbilityTags) const;
+
+	/** Returns a number that changes every time any mapping gets compiled. Used to invalidate results cached outside the mapping. */
+	uint32 GetCompileSerial() const { return CompileSerial; }
+
 	/** Given a set of ability tags, parse the tag relationships and fill out tags to block and cancel. */
 	virtual void GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const;
 
@@ -62,8 +209,95 @@ public:
 	/** Returns true if the specified ability tags are canceled by the passed in action tag. */
 	virtual bool IsAbilityCancelledByTag(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const;
 
+protected:
+	/** Resolves the result for the given ability tags using the evaluation mode. */
+	virtual void EvaluateRelationships(const FGameplayTagContainer& AbilityTags, FModularAbilityTagRelationshipResult& OutResult) const;
+
+	/** Resolves the result for the given ability tags using the compiled bitsets. */
+	void EvaluateRelationshipsBitmask(const FGameplayTagContainer& AbilityTags, FModularAbilityTagRelationshipResult& OutResult) const;
+
+	/** Compiles the relationships into bitsets over the tags they use. */
+	void CompileRelationshipBits();
+
+	/** Returns the relationships of this mapping, merged with the ones of all included mappings. */
+	const TArray<FModularAbilityTagRelationship>& GetRelationships() const
+	{
+		return IncludedMappings.IsEmpty() ? AbilityTagRelationships : MergedRelationships;
+	}
+
+	/**
+	 * Whether results are resolved from the cooked table.
+	 * Only cooked builds honour it, an in-editor cook writes the table onto the live asset, which must keep compiling its edited relationships.
+	 */
+	bool UsesCookedTable() const
+	{
+		return FPlatformProperties::RequiresCookedData() && !CookedTable.IsEmpty();
+	}
+
+	/** Appends the relationships of this mapping and all included mappings, visiting each mapping once. */
+	void GatherRelationships(TArray<FModularAbilityTagRelationship>& OutRelationships, TSet<const UModularAbilityTagRelationshipMapping*>& VisitedMappings) const;
+
 protected:
 	/** The list of relationships between different gameplay tags (which ones block or cancel others). */
 	UPROPERTY(EditDefaultsOnly, Category = Relationships, meta = (TitleProperty = "AbilityTag"))
 	TArray<FModularAbilityTagRelationship> AbilityTagRelationships;
+
+	/** How relationships are resolved for ability tags that weren't resolved before. The results are memoized either way. */
+	UPROPERTY(EditDefaultsOnly, Category = Evaluation)
+	EModularTagRelationshipEvaluation EvaluationMode = EModularTagRelationshipEvaluation::Linear;
+
+	/** Other mappings whose relationships are merged into this one, e.g. one per game feature. */
+	UPROPERTY(EditDefaultsOnly, Category = Relationships)
+	TArray<TObjectPtr<UModularAbilityTagRelationshipMapping>> IncludedMappings;
+
+	/** The merged relationships compiled when this mapping got cooked. Takes precedence over the evaluation mode in cooked builds. */
+	UPROPERTY()
+	FModularCompiledTagRelationshipTable CookedTable;
+
+private:
+	/** Relationships compiled into bitsets over a bit per tag used by any relationship. Bits are owned by the mapping, so they stay valid when tags get registered at runtime. */
+	struct FCompiledRelationshipBits
+	{
+		/** Number of 64 bit words per bitset. */
+		int32 NumWords = 0;
+
+		/** Bit of the ability tag of each relationship, or INDEX_NONE if it has none. */
+		TArray<int32> MatchIndices;
+
+		/** Whether each relationship matches child tags of its ability tag as well. */
+		TBitArray<> MatchPartial;
+
+		/** The four output bitsets of each relationship, NumWords each, in the order of FModularAbilityTagRelationshipResult. */
+		TArray<uint64> OutputWords;
+
+		/** Bit of each tag used by any relationship. */
+		TMap<FGameplayTag, int32> TagBits;
+
+		/** Tag of each bit, the inverse of TagBits. */
+		TArray<FGameplayTag> BitTags;
+
+		/** Whether the bitsets are up to date with the relationships. */
+		bool bValid = false;
+	};
+
+	/** Relationships of this mapping and all included mappings. Only used if there are any included mappings. */
+	TArray<FModularAbilityTagRelationship> MergedRelationships;
+
+	/** Compiled bitsets, used by the bitmask evaluation mode. */
+	FCompiledRelationshipBits CompiledBits;
+
+	/** Union of the tags to cancel of all relationships, for each of their ability tags. Guarded by CachedResultsLock. */
+	TMap<FGameplayTag, FGameplayTagContainer> CancelTagsByActionTag;
+
+	/** Whether the relationships were compiled since they were last modified. */
+	bool bRelationshipsCompiled = false;
+
+	/** Unique number of the last compilation, see GetCompileSerial. */
+	uint32 CompileSerial = 0;
+
+	/** Memoized results for each distinct set of ability tags. The set of distinct ability tag containers is small and stable. */
+	mutable TMap<FGameplayTagContainer, TUniquePtr<FModularAbilityTagRelationshipResult>, FDefaultSetAllocator, FModularAbilityTagContainerKeyFuncs> CachedResults;
+
+	/** Guards CachedResults. */
+	mutable FRWLock CachedResultsLock;
 };
@@ -6,6 +6,10 @@
 
 #include "ModularGameplayAbilitiesSettings.generated.h"
 
+/**
+ * Project wide settings of the plugin, stored in DefaultEngine.ini.
+ * Editable under Project Settings > Game > Modular Abilities Settings, registered by the module on startup.
+ */
 UCLASS(Config=Engine, DefaultConfig, MinimalAPI)
 class UModularGameplayAbilitiesSettings : public UObject
 {
@@ -18,7 +22,18 @@ public:
 	UFUNCTION()
 	static MODULARGAMEPLAYABILITIES_API bool IsNotUsingAlterAbilityInput() { return !GetDefault<ThisClass>()->bEnableAlterAbilityInput; }
 
+	/** Returns the time in seconds a failed input activation is buffered for. */
+	static float GetAbilityInputBufferWindow() { return GetDefault<ThisClass>()->AbilityInputBufferWindow; }
+
 protected:
+	/**
+	 * Time in seconds an input press that failed to activate its ability is buffered for.
+	 * Buffered presses are retried whenever an ability ends, e.g. once a blocking ability has finished.
+	 * Disabled by default, as buffering changes when abilities activate. Set above 0 to opt in.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = Input, meta=(ClampMin=0, ForceUnits="s"))
+	float AbilityInputBufferWindow = 0.f;
+
 	UPROPERTY(Config, EditAnywhere, Category = Experimental, meta=(ConfigRestartRequired=true))
 	bool bEnableAlterAbilityInput = false;
 };
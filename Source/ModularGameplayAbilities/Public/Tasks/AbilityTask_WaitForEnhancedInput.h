@@ -4,12 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "InputActionValue.h"
+#include "InputTriggers.h"
 #include "Abilities/Tasks/AbilityTask.h"
 
 #include "AbilityTask_WaitForEnhancedInput.generated.h"
 
 class UObject;
 class UInputAction;
+class UModularAbilityInputRouter;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FEnhancedInputEventDelegate, FInputActionValue, ActionValue);
 
@@ -62,10 +64,15 @@ protected:
 	void HandleInputCanceled(const FInputActionValue& ActionValue);
 	void HandleInputCompleted(const FInputActionValue& ActionValue);
 
+	/** Forwards routed input events to the handler of the trigger event. */
+	void HandleRoutedInputEvent(ETriggerEvent TriggerEvent, const FInputActionValue& ActionValue);
+
 private:
 	bool bOnePressEventOnly;
 
 	TWeakObjectPtr<UInputAction> InputAction;
 	TWeakObjectPtr<UEnhancedInputComponent> EnhancedInput;
+	TWeakObjectPtr<UModularAbilityInputRouter> InputRouter;
+	FDelegateHandle InputRouterHandle;
 	bool bHasBeenTriggered = false;
 };
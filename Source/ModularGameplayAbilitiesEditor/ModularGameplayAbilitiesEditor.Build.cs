@@ -21,6 +21,8 @@ public class ModularGameplayAbilitiesEditor : ModuleRules
                 "Slate",
                 "SlateCore",
                 "GameplayAbilities",
+                "GameplayTags",
+                "Json",
                 "ModularGameplayAbilities",
                 "UnrealEd",
                 "AssetDefinition",
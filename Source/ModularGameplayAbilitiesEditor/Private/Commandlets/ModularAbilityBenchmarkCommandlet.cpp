@@ -0,0 +1,364 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+
+#include "Commandlets/ModularAbilityBenchmarkCommandlet.h"
+
+#include "ModularAbilitySystemComponent.h"
+#include "ModularGameplayAbilitiesSettings.h"
+#include "NativeGameplayTags.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/MallocBase.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/StrongObjectPtr.h"
+
+#include <atomic>
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ModularAbilityBenchmarkCommandlet)
+
+DEFINE_LOG_CATEGORY_STATIC(LogModularAbilityBenchmark, Log, All);
+
+namespace ModularAbilityBenchmark
+{
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Input_0, "Input.InputTag.Benchmark.0");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Input_1, "Input.InputTag.Benchmark.1");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Input_2, "Input.InputTag.Benchmark.2");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Input_3, "Input.InputTag.Benchmark.3");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Input_4, "Input.InputTag.Benchmark.4");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Input_5, "Input.InputTag.Benchmark.5");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Input_6, "Input.InputTag.Benchmark.6");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Benchmark_Input_7, "Input.InputTag.Benchmark.7");
+
+	/** Forwards to the actual allocator while counting allocations. */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInnerMalloc)
+			: InnerMalloc(InInnerMalloc)
+		{
+		}
+
+		//~ Begin FMalloc Interface
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocs.fetch_add(1, std::memory_order_relaxed);
+			NumBytes.fetch_add(Count, std::memory_order_relaxed);
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				NumAllocs.fetch_add(1, std::memory_order_relaxed);
+				NumBytes.fetch_add(Count, std::memory_order_relaxed);
+			}
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { InnerMalloc->Free(Original); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return InnerMalloc->GetAllocationSize(Original, SizeOut); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return InnerMalloc->QuantizeSize(Count, Alignment); }
+		virtual void Trim(bool bTrimThreadCaches) override { InnerMalloc->Trim(bTrimThreadCaches); }
+		virtual bool IsInternallyThreadSafe() const override { return InnerMalloc->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return InnerMalloc->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("ModularAbilityBenchmark"); }
+		//~ End FMalloc Interface
+
+		FMalloc* InnerMalloc;
+		std::atomic<uint64> NumAllocs = 0;
+		std::atomic<uint64> NumBytes = 0;
+	};
+
+	/** Accumulated measurements of a single benchmark. Only the code between Begin and End is measured. */
+	struct FResult
+	{
+		FString Name;
+		uint64 NumOps = 0;
+		uint64 Cycles = 0;
+		uint64 NumAllocs = 0;
+		uint64 NumBytes = 0;
+
+		void Begin(const FCountingMalloc& Malloc)
+		{
+			StartAllocs = Malloc.NumAllocs.load(std::memory_order_relaxed);
+			StartBytes = Malloc.NumBytes.load(std::memory_order_relaxed);
+			StartCycles = FPlatformTime::Cycles64();
+		}
+
+		void End(const FCountingMalloc& Malloc, uint64 InNumOps)
+		{
+			Cycles += FPlatformTime::Cycles64() - StartCycles;
+			NumAllocs += Malloc.NumAllocs.load(std::memory_order_relaxed) - StartAllocs;
+			NumBytes += Malloc.NumBytes.load(std::memory_order_relaxed) - StartBytes;
+			NumOps += InNumOps;
+		}
+
+		void Reset()
+		{
+			NumOps = 0;
+			Cycles = 0;
+			NumAllocs = 0;
+			NumBytes = 0;
+		}
+
+		TSharedRef<FJsonObject> ToJson() const
+		{
+			const double Ops = FMath::Max<double>(NumOps, 1.0);
+
+			TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetStringField(TEXT("name"), Name);
+			Json->SetNumberField(TEXT("ops"), static_cast<double>(NumOps));
+			Json->SetNumberField(TEXT("ns_per_op"), FPlatformTime::ToSeconds64(Cycles) * 1e9 / Ops);
+			Json->SetNumberField(TEXT("allocs_per_op"), static_cast<double>(NumAllocs) / Ops);
+			Json->SetNumberField(TEXT("bytes_per_op"), static_cast<double>(NumBytes) / Ops);
+			return Json;
+		}
+
+	private:
+		uint64 StartCycles = 0;
+		uint64 StartAllocs = 0;
+		uint64 StartBytes = 0;
+	};
+
+	static void CancelAllAbilities(UModularAbilitySystemComponent* AbilitySystem)
+	{
+		AbilitySystem->CancelAbilitiesByFunc([](const UModularGameplayAbility*, FGameplayAbilitySpecHandle) { return true; }, false);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// AModularAbilityBenchmarkActor
+
+AModularAbilityBenchmarkActor::AModularAbilityBenchmarkActor(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	CreationPolicy = EModularAbilitySystemCreationPolicy::Always;
+	bReplicates = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// UModularAbilityBenchmarkAbility
+
+UModularAbilityBenchmarkAbility::UModularAbilityBenchmarkAbility(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	NetExecutionPolicy = EGameplayAbilityNetExecutionPolicy::LocalOnly;
+	ActivationPolicy = EGameplayAbilityActivationPolicy::Active;
+	ActivationGroup = EGameplayAbilityActivationGroup::Independent;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// UModularAbilityBenchmarkSet
+
+void UModularAbilityBenchmarkSet::AddAbility(TSubclassOf<UGameplayAbility> AbilityClass, const FGameplayTag& InputTag)
+{
+	FModularAbilitySet_GameplayAbility& Ability = Abilities.AddDefaulted_GetRef();
+	Ability.AbilityClass = AbilityClass.Get();
+	Ability.InputTag = InputTag;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// UModularAbilityBenchmarkCommandlet
+
+UModularAbilityBenchmarkCommandlet::UModularAbilityBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = true;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UModularAbilityBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace ModularAbilityBenchmark;
+
+	int32 NumActors = 64;
+	int32 NumAbilities = 16;
+	int32 NumIterations = 200;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("ModularAbilityBenchmark.json");
+
+	FParse::Value(*Params, TEXT("Actors="), NumActors);
+	FParse::Value(*Params, TEXT("Abilities="), NumAbilities);
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	NumActors = FMath::Max(NumActors, 1);
+	NumAbilities = FMath::Max(NumAbilities, 1);
+	NumIterations = FMath::Max(NumIterations, 1);
+
+	if (UModularGameplayAbilitiesSettings::IsUsingAlterAbilityInput())
+	{
+		UE_LOG(LogModularAbilityBenchmark, Error, TEXT("The benchmark drives input through input tags and doesn't support the alter ability input."));
+		return 1;
+	}
+
+	const FGameplayTag InputTags[] =
+	{
+		TAG_Benchmark_Input_0, TAG_Benchmark_Input_1, TAG_Benchmark_Input_2, TAG_Benchmark_Input_3,
+		TAG_Benchmark_Input_4, TAG_Benchmark_Input_5, TAG_Benchmark_Input_6, TAG_Benchmark_Input_7
+	};
+
+	// Abilities are spread over the input tags, so each press activates NumAbilities / NumInputTags abilities
+	const int32 NumInputTags = FMath::Min<int32>(UE_ARRAY_COUNT(InputTags), NumAbilities);
+
+	TStrongObjectPtr<UModularAbilityBenchmarkSet> AbilitySet(NewObject<UModularAbilityBenchmarkSet>(GetTransientPackage(), NAME_None, RF_Transient));
+	for (int32 Idx = 0; Idx < NumAbilities; ++Idx)
+	{
+		AbilitySet->AddAbility(UModularAbilityBenchmarkAbility::StaticClass(), InputTags[Idx % NumInputTags]);
+	}
+
+	// Set up a standalone game world to run in
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ModularAbilityBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	TArray<UModularAbilitySystemComponent*> AbilitySystems;
+	AbilitySystems.Reserve(NumActors);
+
+	for (int32 Idx = 0; Idx < NumActors; ++Idx)
+	{
+		const AModularAbilityBenchmarkActor* Actor = World->SpawnActor<AModularAbilityBenchmarkActor>();
+		UModularAbilitySystemComponent* AbilitySystem = Actor ? Actor->GetModularAbilitySystem() : nullptr;
+		if (!AbilitySystem)
+		{
+			UE_LOG(LogModularAbilityBenchmark, Error, TEXT("Failed to spawn benchmark actor %d."), Idx);
+			continue;
+		}
+
+		AbilitySet->GiveToAbilitySystem(AbilitySystem);
+		AbilitySystems.Add(AbilitySystem);
+	}
+
+	TArray<TArray<FGameplayAbilitySpecHandle>> AbilityHandles;
+	AbilityHandles.SetNum(AbilitySystems.Num());
+	for (int32 Idx = 0; Idx < AbilitySystems.Num(); ++Idx)
+	{
+		for (const FGameplayAbilitySpec& Spec : AbilitySystems[Idx]->GetActivatableAbilities())
+		{
+			AbilityHandles[Idx].Add(Spec.Handle);
+		}
+	}
+
+	FCountingMalloc CountingMalloc(GMalloc);
+	GMalloc = &CountingMalloc;
+
+	FResult InputPressed;
+	InputPressed.Name = TEXT("AbilityInputTagPressed");
+
+	FResult ProcessInput;
+	ProcessInput.Name = TEXT("ProcessAbilityInput");
+
+	FResult TryActivate;
+	TryActivate.Name = TEXT("TryActivateAbility");
+
+	FResult CancelByFunc;
+	CancelByFunc.Name = TEXT("CancelAbilitiesByFunc");
+
+	// The first iteration warms up caches and containers and isn't recorded
+	for (int32 Iteration = 0; Iteration <= NumIterations; ++Iteration)
+	{
+		for (int32 Idx = 0; Idx < AbilitySystems.Num(); ++Idx)
+		{
+			UModularAbilitySystemComponent* AbilitySystem = AbilitySystems[Idx];
+
+			// AbilityInputTagPressed
+			{
+				InputPressed.Begin(CountingMalloc);
+				for (int32 TagIdx = 0; TagIdx < NumInputTags; ++TagIdx)
+				{
+					AbilitySystem->AbilityInputTagPressed(InputTags[TagIdx]);
+				}
+				InputPressed.End(CountingMalloc, NumInputTags);
+			}
+
+			// ProcessAbilityInput, activating all pressed abilities
+			{
+				ProcessInput.Begin(CountingMalloc);
+				AbilitySystem->ProcessAbilityInput(0.f, false);
+				ProcessInput.End(CountingMalloc, 1);
+
+				for (int32 TagIdx = 0; TagIdx < NumInputTags; ++TagIdx)
+				{
+					AbilitySystem->AbilityInputTagReleased(InputTags[TagIdx]);
+				}
+				AbilitySystem->ProcessAbilityInput(0.f, false);
+				CancelAllAbilities(AbilitySystem);
+			}
+
+			// TryActivateAbility
+			{
+				TryActivate.Begin(CountingMalloc);
+				for (const FGameplayAbilitySpecHandle& Handle : AbilityHandles[Idx])
+				{
+					AbilitySystem->TryActivateAbility(Handle);
+				}
+				TryActivate.End(CountingMalloc, AbilityHandles[Idx].Num());
+			}
+
+			// CancelAbilitiesByFunc, canceling the abilities activated above
+			{
+				CancelByFunc.Begin(CountingMalloc);
+				CancelAllAbilities(AbilitySystem);
+				CancelByFunc.End(CountingMalloc, 1);
+			}
+		}
+
+		if (Iteration == 0)
+		{
+			InputPressed.Reset();
+			ProcessInput.Reset();
+			TryActivate.Reset();
+			CancelByFunc.Reset();
+		}
+	}
+
+	GMalloc = CountingMalloc.InnerMalloc;
+
+	// Write the report
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("engine_version"), FEngineVersion::Current().ToString());
+	Report->SetNumberField(TEXT("actors"), AbilitySystems.Num());
+	Report->SetNumberField(TEXT("abilities_per_actor"), NumAbilities);
+	Report->SetNumberField(TEXT("input_tags"), NumInputTags);
+	Report->SetNumberField(TEXT("iterations"), NumIterations);
+
+	TArray<TSharedPtr<FJsonValue>> Results;
+	for (const FResult* Result : { &InputPressed, &ProcessInput, &TryActivate, &CancelByFunc })
+	{
+		Results.Add(MakeShared<FJsonValueObject>(Result->ToJson()));
+		UE_LOG(LogModularAbilityBenchmark, Display, TEXT("%-24s %10.1f ns/op %8.2f allocs/op"),
+			*Result->Name,
+			FPlatformTime::ToSeconds64(Result->Cycles) * 1e9 / FMath::Max<double>(Result->NumOps, 1.0),
+			static_cast<double>(Result->NumAllocs) / FMath::Max<double>(Result->NumOps, 1.0));
+	}
+	Report->SetArrayField(TEXT("results"), Results);
+
+	FString ReportString;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportString);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	const bool bSaved = FFileHelper::SaveStringToFile(ReportString, *OutputPath);
+	if (bSaved)
+	{
+		UE_LOG(LogModularAbilityBenchmark, Display, TEXT("Wrote benchmark report to '%s'."), *OutputPath);
+	}
+	else
+	{
+		UE_LOG(LogModularAbilityBenchmark, Error, TEXT("Failed to write benchmark report to '%s'."), *OutputPath);
+	}
+
+	// Tear down the world
+	World->DestroyWorld(false);
+	GEngine->DestroyWorldContext(World);
+
+	return bSaved ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+﻿// Author: Tom Werner (MajorT), 2026 February
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModularAbilityActor.h"
+#include "ModularAbilitySet.h"
+#include "Abilities/ModularGameplayAbility.h"
+#include "Commandlets/Commandlet.h"
+
+#include "ModularAbilityBenchmarkCommandlet.generated.h"
+
+class UModularAbilitySystemComponent;
+
+/** Ability actor spawned by the benchmark. Always creates its ability system. */
+UCLASS(NotPlaceable, NotBlueprintable, HideDropdown)
+class AModularAbilityBenchmarkActor : public AModularAbilityActor
+{
+	GENERATED_BODY()
+
+public:
+	AModularAbilityBenchmarkActor(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	UModularAbilitySystemComponent* GetModularAbilitySystem() const { return AbilitySystemComponent; }
+};
+
+/** Input activated ability granted by the benchmark. Stays active until it gets canceled. */
+UCLASS(NotBlueprintable, HideDropdown)
+class UModularAbilityBenchmarkAbility : public UModularGameplayAbility
+{
+	GENERATED_BODY()
+
+public:
+	UModularAbilityBenchmarkAbility(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
+
+/** Transient ability set used by the benchmark to grant its abilities. */
+UCLASS(NotBlueprintable, HideDropdown)
+class UModularAbilityBenchmarkSet : public UModularAbilitySet
+{
+	GENERATED_BODY()
+
+public:
+	/** Adds an ability bound to the given input tag. */
+	void AddAbility(TSubclassOf<UGameplayAbility> AbilityClass, const FGameplayTag& InputTag);
+};
+
+/**
+ * Headless benchmark of the ability input and activation path.
+ * Spawns a number of ability actors, grants them abilities through an ability set, drives synthetic input
+ * and reports the time and heap allocations per operation as JSON.
+ *
+ * Usage: UnrealEditor-Cmd <Project> -run=ModularAbilityBenchmark -nullrhi [-Actors=64] [-Abilities=16] [-Iterations=200] [-Output=<File>]
+ */
+UCLASS()
+class UModularAbilityBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UModularAbilityBenchmarkCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};